@@ -1,9 +1,12 @@
 #include "auth.h"
 #include <openssl/sha.h>
+#include <fcntl.h>
 #include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 static void to_hex(const unsigned char *in, size_t len, char out_hex[65]) {
     for (size_t i = 0; i < len; i++)
@@ -22,6 +25,9 @@ void hash_password(const char *password, char out_hex[65]) {
 }
 
 static const char *STATE_FILE = "/home/talkshell_accounts.txt";
+static const char *JOURNAL_FILE = "/home/talkshell_accounts.txt.journal";
+static const char *STATE_TMP_FILE = "/home/talkshell_accounts.txt.tmp";
+#define JOURNAL_COMPACT_LINES 4096 // 저널이 이만큼 쌓이면 계정 파일에 합침
 
 static const UserAccount default_users[] = {
     {.username = "admin1", .password_hash = "bc7fc5f56a1b1aa1d100bf814f3b287021be90b1bbdd7f9caa5583361af6eae2", .permission_level = 10, .locked = false, .failed_attempts = 0},
@@ -29,18 +35,93 @@ static const UserAccount default_users[] = {
     {.username = "opslead", .password_hash = "62b1d9e38c47d84939dd17ec12806e3c64ef63d31a53de4035d7175732e2246b", .permission_level = 7, .locked = false, .failed_attempts = 0},
 };
 
-static UserAccount users[sizeof(default_users) / sizeof(default_users[0])];
+/* ============================================================
+   계정 테이블
+   - 계정 배열은 필요할 때마다 두 배로 늘림 (계정 파일 순서 유지)
+   - 이름 → 배열 위치는 선형 탐사 해시 색인으로 찾아 로그인 시 O(1)
+   - 색인 크기는 계정 수의 두 배 이상으로 유지
+   ============================================================ */
+static UserAccount *users = NULL;
+static size_t user_count = 0;
+static size_t user_cap = 0;
+static int *user_index = NULL; // 해시 칸 → users 위치 (-1 이면 빈 칸)
+static size_t index_cap = 0;   // 항상 2의 거듭제곱
 
 static pthread_mutex_t users_lock = PTHREAD_MUTEX_INITIALIZER;
 static const int MAX_ATTEMPTS = 3;
-static const size_t USER_COUNT = sizeof(users) / sizeof(users[0]);
 
-static void reset_to_defaults_locked(void)
+static size_t hash_name(const char *s)
+{
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    for (; *s; s++)
+        h = (h ^ (unsigned char)*s) * 1099511628211ULL;
+    return (size_t)h;
+}
+
+static void index_insert(size_t pos)
+{
+    size_t mask = index_cap - 1;
+    size_t i = hash_name(users[pos].username) & mask;
+    while (user_index[i] >= 0)
+        i = (i + 1) & mask;
+    user_index[i] = (int)pos;
+}
+
+static bool index_rebuild(size_t cap)
+{
+    int *ni = malloc(sizeof(*ni) * cap);
+    if (!ni)
+        return false;
+    memset(ni, 0xff, sizeof(*ni) * cap); // 모두 -1
+    free(user_index);
+    user_index = ni;
+    index_cap = cap;
+    for (size_t i = 0; i < user_count; i++)
+        index_insert(i);
+    return true;
+}
+
+static UserAccount *find_user(const char *user)
+{
+    if (!user || index_cap == 0)
+        return NULL;
+
+    size_t mask = index_cap - 1;
+    for (size_t i = hash_name(user) & mask; user_index[i] >= 0; i = (i + 1) & mask)
+    {
+        if (strcmp(users[user_index[i]].username, user) == 0)
+            return &users[user_index[i]];
+    }
+    return NULL;
+}
+
+static UserAccount *add_user_locked(const UserAccount *src)
 {
-    memcpy(users, default_users, sizeof(default_users));
+    if (user_count == user_cap)
+    {
+        size_t cap = user_cap ? user_cap * 2 : 16;
+        UserAccount *nu = realloc(users, sizeof(*nu) * cap);
+        if (!nu)
+            return NULL;
+        users = nu;
+        user_cap = cap;
+    }
+    if ((user_count + 1) * 2 > index_cap && !index_rebuild(index_cap ? index_cap * 2 : 64))
+        return NULL;
+
+    users[user_count] = *src;
+    index_insert(user_count);
+    return &users[user_count++];
 }
 
-static UserAccount *find_user(const char *user);
+static void reset_to_defaults_locked(void)
+{
+    user_count = 0;
+    if (user_index)
+        memset(user_index, 0xff, sizeof(*user_index) * index_cap);
+    for (size_t i = 0; i < sizeof(default_users) / sizeof(default_users[0]); i++)
+        add_user_locked(&default_users[i]);
+}
 
 static void load_users_locked(void)
 {
@@ -59,7 +140,14 @@ static void load_users_locked(void)
 
         if (sscanf(line, "%63[^,],%64[^,],%d,%d,%d", username, pw, &perm, &locked, &attempts) == 5)
         {
+            // 기본 계정은 파일 값으로 덮어쓰고, 그 외 계정은 새로 추가
             UserAccount *u = find_user(username);
+            if (!u)
+            {
+                UserAccount fresh = {0};
+                snprintf(fresh.username, sizeof(fresh.username), "%s", username);
+                u = add_user_locked(&fresh);
+            }
             if (u)
             {
                 strncpy(u->password_hash, pw, sizeof(u->password_hash) - 1);
@@ -74,13 +162,48 @@ static void load_users_locked(void)
     fclose(fp);
 }
 
+/* ============================================================
+   계정 상태 저장
+   - 로그인 시도마다 계정 파일 전체를 다시 쓰지 않고, 잠금/실패 횟수가
+     실제로 바뀐 계정만 저널에 한 줄("이름,잠금,실패횟수") 추가
+   - 시작할 때와 저널이 충분히 쌓였을 때 계정 파일에 합치고 저널을 비움
+     (계정 파일은 임시 파일에 쓴 뒤 rename 으로 교체)
+   ============================================================ */
+static int journal_fd = -1;
+static size_t journal_lines = 0;
+
+static void replay_journal_locked(void)
+{
+    FILE *fp = fopen(JOURNAL_FILE, "r");
+    if (!fp)
+        return;
+
+    char line[128];
+    while (fgets(line, sizeof(line), fp))
+    {
+        char username[64] = {0};
+        int locked = 0;
+        int attempts = 0;
+        if (sscanf(line, "%63[^,],%d,%d", username, &locked, &attempts) != 3)
+            continue; // 중간에 끊긴 마지막 줄 등은 무시
+        UserAccount *u = find_user(username);
+        if (u)
+        {
+            u->locked = locked;
+            u->failed_attempts = attempts;
+        }
+    }
+
+    fclose(fp);
+}
+
 static void save_users_locked(void)
 {
-    FILE *fp = fopen(STATE_FILE, "w");
+    FILE *fp = fopen(STATE_TMP_FILE, "w");
     if (!fp)
         return;
 
-    for (size_t i = 0; i < USER_COUNT; i++)
+    for (size_t i = 0; i < user_count; i++)
     {
         UserAccount *u = &users[i];
         fprintf(fp, "%s,%s,%d,%d,%d\n",
@@ -91,20 +214,36 @@ static void save_users_locked(void)
                 u->failed_attempts);
     }
 
-    fclose(fp);
+    bool ok = fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    if (fclose(fp) != 0 || !ok || rename(STATE_TMP_FILE, STATE_FILE) != 0)
+    {
+        unlink(STATE_TMP_FILE);
+        return;
+    }
+
+    // 계정 파일에 모두 반영됐으므로 저널은 비움
+    if (journal_fd >= 0 && ftruncate(journal_fd, 0) == 0)
+        journal_lines = 0;
 }
 
-static UserAccount *find_user(const char *user)
+// 바뀐 계정 하나를 저널에 추가 (한 번의 write 라 줄이 섞이지 않음)
+static void journal_user_locked(const UserAccount *u)
 {
-    if (!user)
-        return NULL;
+    if (journal_fd < 0)
+    {
+        save_users_locked();
+        return;
+    }
 
-    for (size_t i = 0; i < sizeof(users) / sizeof(users[0]); i++)
+    char line[128];
+    int len = snprintf(line, sizeof(line), "%s,%d,%d\n", u->username, u->locked ? 1 : 0, u->failed_attempts);
+    if (len <= 0 || write(journal_fd, line, (size_t)len) != len)
     {
-        if (strcmp(users[i].username, user) == 0)
-            return &users[i];
+        save_users_locked(); // 저널을 쓸 수 없으면 예전처럼 전체 저장
+        return;
     }
-    return NULL;
+    if (++journal_lines >= JOURNAL_COMPACT_LINES)
+        save_users_locked();
 }
 
 bool auth_init(void)
@@ -112,7 +251,10 @@ bool auth_init(void)
     pthread_mutex_lock(&users_lock);
     reset_to_defaults_locked();
     load_users_locked();
-    save_users_locked();
+    replay_journal_locked();
+    if (journal_fd < 0)
+        journal_fd = open(JOURNAL_FILE, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    save_users_locked(); // 저널 내용을 계정 파일에 합치고 저널을 비움
     pthread_mutex_unlock(&users_lock);
     return true;
 }
@@ -159,10 +301,14 @@ AuthResult verify_credentials(const char *user, const char *provided_hash, int *
 
     if (strcmp(u->password_hash, provided_hash) == 0)
     {
-        u->failed_attempts = 0;
         if (out_permission_level)
             *out_permission_level = u->permission_level;
-        save_users_locked();
+        // 실패 횟수가 이미 0 이면 저장할 것이 없음
+        if (u->failed_attempts != 0)
+        {
+            u->failed_attempts = 0;
+            journal_user_locked(u);
+        }
         pthread_mutex_unlock(&users_lock);
         return AUTH_OK;
     }
@@ -171,7 +317,7 @@ AuthResult verify_credentials(const char *user, const char *provided_hash, int *
     if (u->failed_attempts >= MAX_ATTEMPTS)
         u->locked = true;
 
-    save_users_locked();
+    journal_user_locked(u);
 
     int remaining = u->locked ? 0 : (MAX_ATTEMPTS - u->failed_attempts);
     pthread_mutex_unlock(&users_lock);
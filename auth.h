@@ -21,6 +21,7 @@ typedef enum {
     AUTH_INVALID,
 } AuthResult;
 
+bool auth_init(void); // 기본 계정 + 계정 파일 로드 (서버 시작 시 한 번)
 void hash_password(const char *password, char out_hex[65]);
 AuthResult verify_credentials(const char *user, const char *provided_hash, int *out_permission_level, int *out_remaining_attempts);
 bool get_user_info(const char *user, UserAccount *out);
@@ -0,0 +1,114 @@
+#include "list_filter.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ============================================================
+   목록 필터 벤치마크 (make bench)
+   - 가짜 파일 이름 N 개를 만들고 패턴을 한 글자씩 입력
+   - 매번 전체 이름을 처음부터 다시 맞춰 보는 방식과 시간/결과 수를 비교
+   사용법: ./bench_filter [항목 수] [패턴]
+   ============================================================ */
+static const char *words[] = {
+    "Report", "main", "config", "Backup", "index", "README", "test", "util",
+    "server", "Client", "photo", "draft", "notes", "build", "cache", "data",
+};
+static const char *exts[] = {"c", "h", "txt", "log", "md", "png", "json", "tar.gz"};
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// 비교 대상: 소문자 키 없이 매번 이름 전체를 대소문자 무시하고 부분 순서 일치
+static bool naive_match(const char *name, const char *pat)
+{
+    for (; *pat; pat++)
+    {
+        int c = tolower((unsigned char)*pat);
+        while (*name && tolower((unsigned char)*name) != c)
+            name++;
+        if (!*name)
+            return false;
+        name++;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 200000;
+    const char *pattern = argc > 2 ? argv[2] : "repcfg2log";
+    if (n <= 0)
+        n = 200000;
+
+    char **items = malloc(sizeof(char *) * (size_t)n);
+    srand(42);
+    for (int i = 0; i < n; i++)
+    {
+        char name[128];
+        snprintf(name, sizeof(name), "%s_%s%d.%s",
+                 words[rand() % 16], words[rand() % 16], rand() % 100000, exts[rand() % 8]);
+        items[i] = strdup(name);
+    }
+
+    ListFilter f;
+    double t0 = now_ms();
+    if (!filter_begin(&f, items, n, 0, false))
+    {
+        fprintf(stderr, "filter_begin failed\n");
+        return 1;
+    }
+    printf("items: %d, key build: %.2f ms\n\n", n, now_ms() - t0);
+    printf("%-14s %10s %12s %10s %12s\n", "pattern", "matches", "incr(ms)", "naive", "naive(ms)");
+
+    char typed[FILTER_PATTERN_MAX] = {0};
+    double incr_total = 0, naive_total = 0;
+    int mismatch = 0;
+    for (size_t k = 0; pattern[k] && k + 1 < sizeof(typed); k++)
+    {
+        typed[k] = pattern[k];
+
+        t0 = now_ms();
+        filter_push(&f, pattern[k]);
+        double incr = now_ms() - t0;
+
+        t0 = now_ms();
+        int naive = 0;
+        for (int i = 0; i < n; i++)
+            if (naive_match(items[i], typed))
+                naive++;
+        double naive_ms = now_ms() - t0;
+
+        int got = filter_result(&f)->count;
+        if (got != naive)
+            mismatch++;
+        incr_total += incr;
+        naive_total += naive_ms;
+        printf("%-14s %10d %12.3f %10d %12.3f\n", typed, got, incr, naive, naive_ms);
+    }
+
+    t0 = now_ms();
+    while (f.len > 0)
+        filter_pop(&f);
+    double pop_ms = now_ms() - t0;
+
+    printf("\ntotal: incremental %.2f ms, naive %.2f ms (x%.1f)\n",
+           incr_total, naive_total, incr_total > 0 ? naive_total / incr_total : 0.0);
+    printf("backspace to empty: %.3f ms, result count %d\n", pop_ms, filter_result(&f)->count);
+
+    filter_end(&f);
+    for (int i = 0; i < n; i++)
+        free(items[i]);
+    free(items);
+    if (mismatch)
+    {
+        printf("MISMATCH in %d steps\n", mismatch);
+        return 1;
+    }
+    return 0;
+}
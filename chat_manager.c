@@ -2,29 +2,298 @@
 #include "chat_manager.h"
 #include "utils.h"
 #include <sys/stat.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-static void ensure_log_ready(const char *path) {
+static void ensure_log_dir(const char *path) {
     char dir[PATH_MAX]; snprintf(dir, sizeof(dir), "%s", path);
     // 마지막 '/' 이전을 디렉토리로 보고 생성
     for (int i=strlen(dir)-1;i>=0;--i) {
         if (dir[i]=='/') { dir[i]='\0'; break; }
     }
     ensure_dir(dir);
-    // 파일 없으면 생성
-    FILE *f = fopen(path, "a"); if (f) fclose(f);
+}
+
+#define TAIL_BLOCK 8192
+
+static void ring_push(ChatState *st, const char *line, size_t len)
+{
+    char *s = malloc(len + 1);
+    if (!s) return;
+    memcpy(s, line, len);
+    s[len] = '\0';
+    if (len && s[len-1] == '\r') s[len-1] = '\0';
+
+    if (st->ring_count < CHAT_RING_LINES) {
+        st->ring[(st->ring_head + st->ring_count) % CHAT_RING_LINES] = s;
+        st->ring_count++;
+    } else {
+        // 가득 차면 가장 오래된 줄을 버림
+        free(st->ring[st->ring_head]);
+        st->ring[st->ring_head] = s;
+        st->ring_head = (st->ring_head + 1) % CHAT_RING_LINES;
+    }
+    st->ring_seq++;
+}
+
+static void ring_clear(ChatState *st) {
+    for (int i=0;i<st->ring_count;i++)
+        free(st->ring[(st->ring_head + i) % CHAT_RING_LINES]);
+    st->ring_head = st->ring_count = 0;
+    st->painted = false;
+}
+
+// read_off 이후에 붙은 완성된 줄만 ring 에 추가 (개행 없는 마지막 조각은 다음에)
+static bool read_new_lines(ChatState *st, off_t size) {
+    bool added = false;
+    char *carry = NULL; size_t carry_len = 0;
+    char buf[64 * 1024];
+
+    off_t pos = st->read_off;
+    while (pos < size) {
+        size_t want = (size - pos) < (off_t)sizeof(buf) ? (size_t)(size - pos) : sizeof(buf);
+        ssize_t n = pread(st->log_fd, buf, want, pos);
+        if (n <= 0) break;
+        pos += n;
+
+        size_t start = 0;
+        for (size_t i=0;i<(size_t)n;i++) {
+            if (buf[i] != '\n') continue;
+            if (carry_len) {
+                // 블록 경계에 걸친 줄
+                char *p = realloc(carry, carry_len + (i - start));
+                if (p) { carry = p; memcpy(carry + carry_len, buf + start, i - start); }
+                ring_push(st, carry, carry_len + (p ? i - start : 0));
+                carry_len = 0;
+            } else {
+                ring_push(st, buf + start, i - start);
+            }
+            st->read_off = pos - n + i + 1;
+            added = true;
+            start = i + 1;
+        }
+        if (start < (size_t)n) {
+            char *p = realloc(carry, carry_len + (n - start));
+            if (!p) break;
+            carry = p;
+            memcpy(carry + carry_len, buf + start, n - start);
+            carry_len += n - start;
+        }
+    }
+    free(carry);
+    return added;
+}
+
+// 파일 끝에서 거꾸로 블록을 읽어 최근 CHAT_RING_LINES 줄의 시작 위치를 찾음
+static off_t find_tail_start(int fd, off_t size) {
+    char blk[TAIL_BLOCK];
+    off_t pos = size;
+    int nl = 0;
+    while (pos > 0) {
+        size_t n = pos < (off_t)sizeof(blk) ? (size_t)pos : sizeof(blk);
+        pos -= n;
+        if (pread(fd, blk, n, pos) != (ssize_t)n) return 0;
+        for (size_t i=n;i-- > 0;) {
+            if (blk[i] == '\n' && ++nl > CHAT_RING_LINES)
+                return pos + i + 1;
+        }
+    }
+    return 0;
+}
+
+static void load_tail(ChatState *st) {
+    ring_clear(st);
+    st->read_off = 0;
+    struct stat s;
+    if (st->log_fd < 0 || fstat(st->log_fd, &s) != 0) return;
+    st->read_off = find_tail_start(st->log_fd, s.st_size);
+    read_new_lines(st, s.st_size);
+}
+
+/* ============================================================
+   줄 오프셋 색인 (<로그>.idx)
+   - k 번째 항목 = k 번째 줄이 끝난 바로 다음 위치 (uint64)
+   - 로그에 붙은 새 바이트만 훑어 색인을 늘림 (처음 한 번만 전체)
+   - 스크롤 시 필요한 몇 줄만 pread 하므로 로그 길이와 무관
+   ============================================================ */
+static void idx_lock(int fd, short type) {
+    struct flock fl = {0};
+    fl.l_type = type; fl.l_whence = SEEK_SET;
+    fcntl(fd, F_SETLKW, &fl);
+}
+
+static bool idx_entry(const ChatState *st, long k, uint64_t *out) {
+    if (k < 0) { *out = 0; return true; }
+    return pread(st->idx_fd, out, sizeof(*out), (off_t)k * sizeof(*out)) == sizeof(*out);
+}
+
+// 다른 프로세스가 늘린 색인까지 반영해 idx_lines / idx_upto 를 다시 읽음
+static void idx_reload(ChatState *st) {
+    struct stat s;
+    if (fstat(st->idx_fd, &s) != 0) return;
+    st->idx_lines = s.st_size / (off_t)sizeof(uint64_t);
+    uint64_t last = 0;
+    if (st->idx_lines > 0 && idx_entry(st, st->idx_lines - 1, &last))
+        st->idx_upto = (off_t)last;
+    else
+        st->idx_upto = 0;
+}
+
+// idx_upto 이후의 로그를 훑어 색인 뒤에 붙임. 쓰기에 실패하면 false
+static bool idx_extend(ChatState *st) {
+    char buf[64 * 1024];
+    uint64_t ends[1024]; int ne = 0;
+    off_t pos = st->idx_upto;
+    ssize_t n;
+    while ((n = pread(st->log_fd, buf, sizeof(buf), pos)) > 0) {
+        for (ssize_t i=0;i<n;i++) {
+            if (buf[i] != '\n') continue;
+            ends[ne++] = (uint64_t)(pos + i + 1);
+            if (ne == (int)(sizeof(ends)/sizeof(ends[0]))) {
+                if (write(st->idx_fd, ends, sizeof(ends)) != (ssize_t)sizeof(ends)) return false;
+                st->idx_lines += ne; ne = 0;
+            }
+        }
+        pos += n;
+    }
+    if (ne > 0) {
+        if (write(st->idx_fd, ends, sizeof(uint64_t) * ne) != (ssize_t)(sizeof(uint64_t) * ne)) return false;
+        st->idx_lines += ne;
+    }
+    return true;
+}
+
+// 색인을 비우고 처음부터 다시 만듦. 그것도 안 되면 색인 파일을 지우고 색인 없이 (링 버퍼만으로) 동작
+static void idx_rebuild(ChatState *st) {
+    st->idx_lines = 0; st->idx_upto = 0;
+    if (ftruncate(st->idx_fd, 0) == 0 && idx_extend(st)) return;
+    char path[PATH_MAX + 8];
+    snprintf(path, sizeof(path), "%s.idx", st->log_path);
+    unlink(path);
+    idx_lock(st->idx_fd, F_UNLCK);
+    close(st->idx_fd);
+    st->idx_fd = -1;
+    st->idx_lines = 0; st->idx_upto = 0;
+}
+
+static void idx_catch_up(ChatState *st) {
+    if (st->idx_fd < 0 || st->log_fd < 0) return;
+    long known = st->idx_lines;
+    idx_lock(st->idx_fd, F_WRLCK);
+    idx_reload(st);
+
+    struct stat ls;
+    if (fstat(st->log_fd, &ls) == 0 && ls.st_size < st->idx_upto)
+        idx_rebuild(st); // 로그가 잘렸으면 색인을 처음부터 다시 만듦
+    else if (!idx_extend(st))
+        idx_rebuild(st); // 쓰다 만 항목이 남았을 수 있으니 믿지 않고 다시 만듦
+    if (st->idx_fd < 0) { st->scroll = 0; return; }
+    idx_reload(st);
+    idx_lock(st->idx_fd, F_UNLCK);
+
+    // 과거를 보고 있으면 새 줄이 붙어도 보던 위치를 유지
+    if (st->scroll > 0 && st->idx_lines > known)
+        st->scroll += st->idx_lines - known;
+    if (st->scroll > st->idx_lines - 1) st->scroll = st->idx_lines > 0 ? st->idx_lines - 1 : 0;
+}
+
+static void idx_open(ChatState *st) {
+    char path[PATH_MAX + 8];
+    snprintf(path, sizeof(path), "%s.idx", st->log_path);
+    st->idx_fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (st->idx_fd < 0) return;
+    struct stat s;
+    // 쓰다 만 항목이 있으면 잘라냄
+    if (fstat(st->idx_fd, &s) == 0 && s.st_size % (off_t)sizeof(uint64_t) &&
+        ftruncate(st->idx_fd, s.st_size - s.st_size % (off_t)sizeof(uint64_t)) != 0) {
+        idx_lock(st->idx_fd, F_WRLCK);
+        idx_rebuild(st);
+        if (st->idx_fd < 0) return;
+        idx_lock(st->idx_fd, F_UNLCK);
+    }
+    idx_catch_up(st);
+}
+
+/* ============================================================
+   서버 기록 위치 (<로그>.since)
+   - 받은 가장 큰 서버 ts 와 그 ts 로 받은 개수를 "ts seen" 한 줄로 남김
+   - 재접속 때 JOIN since 로 보내 빠진 부분만 받음 (로컬 시계와 무관)
+   ============================================================ */
+static void since_save(ChatState *st) {
+    st->since_dirty = false;
+    if (st->since_fd < 0) return;
+    char buf[48];
+    int n = snprintf(buf, sizeof(buf), "%lld %d\n", st->srv_ts, st->srv_seen);
+    if (pwrite(st->since_fd, buf, (size_t)n, 0) == n) ftruncate(st->since_fd, n);
+}
+
+static void since_open(ChatState *st) {
+    char path[PATH_MAX + 8];
+    snprintf(path, sizeof(path), "%s.since", st->log_path);
+    st->since_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (st->since_fd < 0) return;
+    char buf[48];
+    ssize_t n = pread(st->since_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return;
+    buf[n] = '\0';
+    if (sscanf(buf, "%lld %d", &st->srv_ts, &st->srv_seen) != 2 || st->srv_ts < 0 || st->srv_seen < 0)
+        st->srv_ts = 0, st->srv_seen = 0;
+}
+
+void chat_server_seen(ChatState *st, long long ts) {
+    if (ts > st->srv_ts) { st->srv_ts = ts; st->srv_seen = 1; }
+    else if (ts == st->srv_ts) st->srv_seen++;
+    else return; // 이미 지나간 초 (늦게 처리된 응답 등)
+    if (st->batch_depth > 0) st->since_dirty = true;
+    else since_save(st);
+}
+
+bool chat_server_since(const ChatState *st, long long *ts, int *seen) {
+    if (st->srv_ts <= 0) return false;
+    *ts = st->srv_ts; *seen = st->srv_seen;
+    return true;
+}
+
+void chat_scroll(ChatState *st, long delta) {
+    st->scroll += delta;
+    if (st->scroll > st->idx_lines - 1) st->scroll = st->idx_lines - 1;
+    if (st->scroll < 0) st->scroll = 0;
+    st->painted = false;
+    st->dirty = 1;
+}
+
+void chat_free(ChatState *st) {
+    chat_flush(st);
+    free(st->pend);
+    st->pend = NULL; st->pend_len = st->pend_cap = 0;
+    ring_clear(st);
+    if (st->log_fd >= 0) close(st->log_fd);
+    if (st->since_dirty) since_save(st);
+    if (st->idx_fd >= 0) close(st->idx_fd);
+    if (st->append_fd >= 0) close(st->append_fd);
+    if (st->since_fd >= 0) close(st->since_fd);
+    st->log_fd = st->idx_fd = st->append_fd = st->since_fd = -1;
 }
 
 void chat_init(ChatState *st, const char *dir_abs) {
+    if (st->log_path[0]) chat_free(st);
     memset(st, 0, sizeof(*st));
     snprintf(st->dir_abs, sizeof(st->dir_abs), "%s", dir_abs);
     make_log_path(st->log_path, dir_abs);
-    ensure_log_ready(st->log_path);
-    struct stat s;
-    st->last_mtime = (stat(st->log_path, &s)==0)? s.st_mtime : 0;
+    snprintf(st->room, sizeof(st->room), "%s", dir_abs);
+    for (char *p = st->room; *p; ++p) if (isspace((unsigned char)*p)) *p = '_';
+    ensure_log_dir(st->log_path);
+    st->append_fd = open(st->log_path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    st->log_fd = open(st->log_path, O_RDONLY | O_CLOEXEC);
+    load_tail(st);
+    idx_open(st);
+    since_open(st);
     st->dirty = 1;
 }
 
@@ -35,60 +304,177 @@ static void draw_centered(WINDOW *win, int row, const char *msg) {
     mvwprintw(win, row, x, "%s", msg);
 }
 
-void chat_draw(WINDOW *win, const ChatState *st) {
-    werase(win); box(win,0,0);
-    mvwprintw(win,0,2," 채팅: %s ", st->dir_abs);
+// 스크롤 중: 색인에서 화면에 보일 줄의 오프셋만 읽고, 그 구간만 로그에서 읽음
+static void draw_from_index(WINDOW *win, const ChatState *st, int maxlines, int w) {
+    long last = st->idx_lines - 1 - st->scroll;  // 화면 맨 아래 줄 번호
+    long first = last - maxlines + 1;
+    if (first < 0) first = 0;
+    mvwprintw(win, 0, w - 20 > 2 ? w - 20 : 2, " ↑ %ld줄 위 ", st->scroll);
 
-    FILE *fp = fopen(st->log_path, "r");
+    char line[1024];
+    for (long k=first, row=1; k<=last; k++, row++) {
+        uint64_t start, end;
+        if (!idx_entry(st, k - 1, &start) || !idx_entry(st, k, &end) || end <= start) continue;
+        size_t len = end - start - 1; // 개행 제외
+        if (len >= sizeof(line)) len = sizeof(line) - 1;
+        ssize_t n = pread(st->log_fd, line, len, (off_t)start);
+        if (n < 0) n = 0;
+        line[n] = '\0';
+        if (n && line[n-1] == '\r') line[n-1] = '\0';
+        mvwprintw(win, (int)row, 1, "%.*s", w-2, line);
+    }
+}
+
+// 최신 줄을 따라가는 중에 붙은 줄만 그림: 빈 줄이 있으면 그 아래에, 없으면 채팅 영역을
+// 그만큼 위로 밀고 맨 아래에 (idlok 가 켜져 있으면 터미널 스크롤로 내보내므로 창 전체를 다시 보내지 않음)
+static bool draw_appended(WINDOW *win, ChatState *st, int maxlines, int w) {
+    unsigned long added = st->ring_seq - st->painted_seq;
+    if (added == 0) return true;
+    if (added >= (unsigned long)maxlines || added > (unsigned long)st->ring_count) return false;
+    int k = (int)added;
+    int shown = st->ring_count - k < maxlines ? st->ring_count - k : maxlines; // 이미 그려진 줄 수
+    int shift = shown + k > maxlines ? shown + k - maxlines : 0;
+    if (shift > 0) {
+        wsetscrreg(win, 1, maxlines);
+        scrollok(win, TRUE);
+        wscrl(win, shift);
+        scrollok(win, FALSE);
+    }
+    for (int i=0;i<k;i++) {
+        int row = shown - shift + 1 + i;
+        const char *s = st->ring[(st->ring_head + st->ring_count - k + i) % CHAT_RING_LINES];
+        mvwaddch(win, row, 0, ACS_VLINE);
+        mvwprintw(win, row, 1, "%.*s", w-2, s);
+        mvwaddch(win, row, w-1, ACS_VLINE);
+    }
+    return true;
+}
+
+void chat_draw(WINDOW *win, ChatState *st) {
     int h,w; getmaxyx(win,h,w);
     int maxlines = h-2;
-    if (!fp) {
-        draw_centered(win, h/2, "(로그 파일을 열 수 없습니다)");
-        wrefresh(win); return;
-    }
-    // 최근 maxlines줄만 출력
-    char **lines = calloc(maxlines, sizeof(char*));
-    int cnt=0;
-    char buf[8192];
-    while (fgets(buf, sizeof(buf), fp)) {
-        if (cnt < maxlines) {
-            lines[cnt++] = strdup(buf);
-        } else {
-            free(lines[0]);
-            memmove(&lines[0], &lines[1], sizeof(char*)*(maxlines-1));
-            lines[maxlines-1] = strdup(buf);
-        }
+    if (st->painted && st->scroll == 0 && st->log_fd >= 0 && draw_appended(win, st, maxlines, w)) {
+        st->painted_seq = st->ring_seq;
+        wnoutrefresh(win); return;
     }
-    fclose(fp);
 
+    werase(win); box(win,0,0);
+    mvwprintw(win,0,2," 채팅: %s ", st->dir_abs);
+    st->painted = false;
+    if (st->log_fd < 0) {
+        draw_centered(win, h/2, "(로그 파일을 열 수 없습니다)");
+        wnoutrefresh(win); return;
+    }
+    if (st->scroll > 0 && st->idx_fd >= 0) {
+        draw_from_index(win, st, maxlines, w);
+        wnoutrefresh(win); return;
+    }
+    // 최근 maxlines줄만 출력 (파일을 다시 읽지 않고 ring 에서)
+    int cnt = st->ring_count < maxlines ? st->ring_count : maxlines;
+    int first = st->ring_count - cnt;
     for (int i=0;i<cnt;i++) {
-        // 개행 제거
-        char *s = lines[i]; size_t L = strlen(s);
-        if (L && (s[L-1]=='\n' || s[L-1]=='\r')) s[L-1]='\0';
+        const char *s = st->ring[(st->ring_head + first + i) % CHAT_RING_LINES];
         mvwprintw(win, i+1, 1, "%.*s", w-2, s);
-        free(lines[i]);
     }
-    free(lines);
-    wrefresh(win);
+    st->painted = true;
+    st->painted_seq = st->ring_seq;
+    wnoutrefresh(win);
+}
+
+/* ============================================================
+   로그 쓰기
+   - 로그는 O_APPEND 로 한 번 열어 두고 메시지마다 write 한 번
+   - 타임스탬프 문자열은 초가 바뀔 때만 다시 만듦
+   - 묶음 모드에서는 줄을 모아 두었다가 한꺼번에 쓰고 색인도 한 번만 갱신
+   ============================================================ */
+#define PEND_FLUSH_SIZE (64 * 1024)
+
+static ChatDurability durability = CHAT_SYNC_NONE;
+
+void chat_set_durability(ChatDurability level) {
+    durability = level;
+}
+
+static const char *cached_timestamp(time_t t) {
+    static time_t cached_sec = (time_t)-1;
+    static char ts[32];
+    if (t != cached_sec) {
+        struct tm tm; localtime_r(&t, &tm);
+        strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", &tm);
+        cached_sec = t;
+    }
+    return ts;
 }
 
-bool chat_append(const ChatState *st, const char *user, const char *msg) {
-    FILE *fp = fopen(st->log_path, "a");
-    if (!fp) return false;
-    time_t now = time(NULL);
-    struct tm tm; localtime_r(&now, &tm);
-    char ts[64]; strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", &tm);
-    fprintf(fp, "[%s] %s: %s\n", ts, user?user:"user", msg?msg:"");
-    fclose(fp);
+static bool write_all(int fd, const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) return false;
+        p += n; len -= (size_t)n;
+    }
     return true;
 }
 
+bool chat_flush(ChatState *st) {
+    if (st->pend_len == 0) return true;
+    bool ok = st->append_fd >= 0 && write_all(st->append_fd, st->pend, st->pend_len);
+    st->pend_len = 0;
+    if (ok && durability != CHAT_SYNC_NONE) fdatasync(st->append_fd);
+    idx_catch_up(st);
+    return ok;
+}
+
+void chat_begin_batch(ChatState *st) {
+    st->batch_depth++;
+}
+
+bool chat_end_batch(ChatState *st) {
+    if (st->batch_depth > 0 && --st->batch_depth > 0) return true;
+    bool ok = chat_flush(st);
+    if (st->since_dirty) since_save(st); // 로그를 쓴 다음에 위치를 남김
+    return ok;
+}
+
+bool chat_append(ChatState *st, const char *user, const char *msg) {
+    return chat_append_at(st, time(NULL), user, msg);
+}
+
+bool chat_append_at(ChatState *st, time_t when, const char *user, const char *msg) {
+    if (st->append_fd < 0) return false;
+    user = user ? user : "user";
+    msg = msg ? msg : "";
+    const char *ts = cached_timestamp(when);
+
+    size_t need = strlen(ts) + strlen(user) + strlen(msg) + 8;
+    if (st->pend_len + need > st->pend_cap) {
+        size_t cap = st->pend_cap ? st->pend_cap : 4096;
+        while (cap < st->pend_len + need) cap *= 2;
+        char *p = realloc(st->pend, cap);
+        if (!p) return false;
+        st->pend = p; st->pend_cap = cap;
+    }
+    st->pend_len += (size_t)snprintf(st->pend + st->pend_len, st->pend_cap - st->pend_len,
+                                     "[%s] %s: %s\n", ts, user, msg);
+
+    if (st->batch_depth > 0 && st->pend_len < PEND_FLUSH_SIZE) return true;
+    bool ok = write_all(st->append_fd, st->pend, st->pend_len);
+    st->pend_len = 0;
+    if (ok && (durability == CHAT_SYNC_ALWAYS || (durability == CHAT_SYNC_BATCH && st->batch_depth == 0)))
+        fdatasync(st->append_fd);
+    if (st->batch_depth == 0) idx_catch_up(st);
+    return ok;
+}
+
 void chat_check_update(ChatState *st) {
     struct stat s;
-    if (stat(st->log_path, &s)==0) {
-        if (s.st_mtime != st->last_mtime) {
-            st->last_mtime = s.st_mtime;
+    if (st->log_fd < 0 || fstat(st->log_fd, &s) != 0) return;
+    if (s.st_size < st->read_off) {
+        // 로그가 잘렸으면 처음부터 다시
+        load_tail(st);
+        st->dirty = 1;
+    } else if (s.st_size > st->read_off) {
+        if (read_new_lines(st, s.st_size))
             st->dirty = 1;
-        }
+        idx_catch_up(st);
     }
 }
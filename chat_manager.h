@@ -4,18 +4,57 @@
 #include <ncurses.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <sys/types.h>
 #include <time.h>
 
+#define CHAT_RING_LINES 512   // 화면용으로 메모리에 들고 있는 최근 줄 수
+#define CHAT_ROOM_MAX 256     // 서버 방 이름 최대 길이 (NUL 포함)
+
+// 로그 기록의 내구성 수준
+typedef enum {
+    CHAT_SYNC_NONE = 0,  // write 만 (OS 버퍼에 맡김, 기본값)
+    CHAT_SYNC_BATCH,     // 묶음을 내보낼 때마다 fdatasync
+    CHAT_SYNC_ALWAYS,    // 쓸 때마다 fdatasync
+} ChatDurability;
+
 typedef struct {
     char dir_abs[PATH_MAX];   // 현재 채팅 대상 디렉토리(절대경로)
     char log_path[PATH_MAX];  // 로그 파일 경로
-    time_t last_mtime;        // 마지막 수정 시간 (변경 감지용)
+    char room[CHAT_ROOM_MAX]; // 서버 방 이름 (dir_abs 의 공백을 '_' 로 바꾼 것)
+    int log_fd;               // 읽기용으로 열어 둔 로그 (-1 이면 없음)
+    int append_fd;            // 쓰기용 (O_APPEND), 메시지마다 열고 닫지 않음
+    char *pend;               // 묶음 모드에서 아직 쓰지 않은 줄들
+    size_t pend_len, pend_cap;
+    int batch_depth;          // chat_begin_batch 중첩 수
+    off_t read_off;           // 여기까지 읽어 ring 에 반영함 (항상 줄 경계)
+    char *ring[CHAT_RING_LINES]; // 최근 줄 원형 버퍼
+    int ring_head, ring_count;   // 가장 오래된 줄 위치, 들어 있는 줄 수
+    int idx_fd;               // 줄 끝 오프셋 색인 (<로그>.idx, uint64 배열)
+    long idx_lines;           // 색인된 줄 수
+    off_t idx_upto;           // 로그에서 색인이 끝난 위치
+    long scroll;              // 맨 아래에서 위로 올라간 줄 수 (0 이면 최신 줄을 따라감)
+    unsigned long ring_seq;   // 지금까지 ring 에 넣은 줄 수 (그리기용 변경 추적)
+    unsigned long painted_seq; // 마지막으로 그렸을 때의 ring_seq
+    bool painted;             // false 면 다음 chat_draw 에서 창 전체를 다시 그림
+    long long srv_ts;         // 이 방에서 받은 가장 큰 서버 ts (0 이면 아직 없음)
+    int srv_seen;             // srv_ts 로 받은 기록 수 (같은 초에 여러 개일 수 있음)
+    int since_fd;             // srv_ts/srv_seen 을 남겨 두는 파일 (<로그>.since)
+    bool since_dirty;         // 묶음 중에 바뀌어 아직 저장하지 않음
     volatile int dirty;       // 외부 변경 플래그
 } ChatState;
 
-void chat_init(ChatState *st, const char *dir_abs);
-void chat_draw(WINDOW *win, const ChatState *st);
-bool chat_append(const ChatState *st, const char *user, const char *msg);
-void chat_check_update(ChatState *st); // 파일 변경 감지
+void chat_init(ChatState *st, const char *dir_abs); // st 는 0 으로 초기화됐거나 이전에 chat_init 된 상태
+void chat_free(ChatState *st);
+void chat_draw(WINDOW *win, ChatState *st); // 새로 붙은 줄만 그리고 wnoutrefresh (doupdate 는 호출자)
+bool chat_append(ChatState *st, const char *user, const char *msg);
+bool chat_append_at(ChatState *st, time_t ts, const char *user, const char *msg); // 서버 기록처럼 시각이 정해진 메시지
+void chat_server_seen(ChatState *st, long long ts); // 서버 기록 하나를 받음 (MSG 줄, 내 SAY 의 ACK)
+bool chat_server_since(const ChatState *st, long long *ts, int *seen); // JOIN 에 보낼 위치 (없으면 false)
+void chat_begin_batch(ChatState *st);  // 이후 chat_append 는 모아 두었다가
+bool chat_end_batch(ChatState *st);    // 여기서 한 번의 write 로 내보냄
+bool chat_flush(ChatState *st);
+void chat_set_durability(ChatDurability level);
+void chat_check_update(ChatState *st); // 파일 변경 감지 (늘어난 부분만 읽음)
+void chat_scroll(ChatState *st, long delta); // 양수: 과거로, 음수: 최신 쪽으로. 색인 범위 안으로 맞춤
 
 #endif
@@ -4,42 +4,409 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <arpa/inet.h>
-#include <pthread.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
 #include <sys/stat.h> // mkdir
 #include <dirent.h>   // opendir/readdir for optional checks
 #include <errno.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <limits.h>
+#include <time.h>
 
 #include "auth.h"
+#include "client_registry.h"
+#include "dir_listing.h"
+#include "history_store.h"
+#include "room_manager.h"
+#include "session_store.h"
 
 // #define PORT 5050
-#define MAX_CLIENTS 20
+#define MAX_EVENTS 64
+#define LIST_PAGE_MAX 4096 // LSPAGE 한 번에 보낼 수 있는 최대 항목 수
+#define HISTORY_JOIN_LINES 50  // JOIN 시 기준 시각이 없으면 다시 보내는 최근 메시지 수
+#define HISTORY_MAX_LINES 1000 // HISTORY/JOIN 한 번에 보내는 최대 메시지 수
+#define DEFAULT_ROOM "lobby"   // JOIN 전에 보낸 말머리 없는 메시지의 방
+
+void error_handling(char *message);
+
+static int epfd = -1;
+static int root_fd = -1; // 서버 시작 디렉토리 (새 세션의 작업 디렉토리)
+static ClientSlot *dirty_head = NULL; // flush 대기 중인 연결 목록
+static ClientSlot *closed_head = NULL; // 이번 epoll_wait 묶음에서 닫은 연결 (묶음이 끝나면 반납)
+
+static void set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0)
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+typedef enum
+{
+    SLOW_DROP,       // 큐가 넘치면 새 브로드캐스트를 버림
+    SLOW_COALESCE,   // 밀린 브로드캐스트를 안내 한 줄로 합침
+    SLOW_DISCONNECT, // 느린 수신자 연결 종료
+} SlowPolicy;
+
+static SlowPolicy slow_policy = SLOW_DROP;
+static size_t queue_limit = 256 * 1024; // 연결당 송신 큐 상한 (바이트)
+
+// 송신 큐 통계 (STATS 명령으로 노출)
+static struct
+{
+    size_t queued_bytes;     // 전체 연결의 대기 바이트 합
+    size_t peak_depth;       // 한 연결의 최대 큐 깊이
+    unsigned long dropped;   // 버린 브로드캐스트 수
+    unsigned long coalesced; // 합쳐진 브로드캐스트 수
+    unsigned long slow_disconnects;
+} qstats;
+
+static void slot_update_events(ClientSlot *slot)
+{
+    unsigned int mask = EPOLLRDHUP;
+    if (!slot->read_paused)
+        mask |= EPOLLIN;
+    if (slot->outq.bytes > 0 && !slot->closing)
+        mask |= EPOLLOUT;
+    if (slot->ev_mask == mask)
+        return;
+    struct epoll_event ev = {0};
+    ev.events = mask;
+    ev.data.ptr = slot;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, slot->sock, &ev);
+    slot->ev_mask = mask;
+}
+
+static void mark_dirty(ClientSlot *slot)
+{
+    if (!slot->dirty)
+    {
+        slot->dirty = true;
+        slot->next_dirty = dirty_head;
+        dirty_head = slot;
+    }
+}
+
+static void queue_push(ClientSlot *slot, const char *data, size_t len, bool droppable)
+{
+    if (!outq_push(&slot->outq, data, len, droppable))
+    {
+        slot->closing = true;
+        return;
+    }
+    qstats.queued_bytes += len;
+    if (slot->outq.bytes > qstats.peak_depth)
+        qstats.peak_depth = slot->outq.bytes;
+    mark_dirty(slot);
+}
+
+// 송신 데이터를 연결 큐에 쌓아두고, 이벤트 처리가 끝난 뒤 한꺼번에 내보낸다.
+static void slot_send(ClientSlot *slot, const char *data, size_t len)
+{
+    if (slot->sock <= 0 || slot->closing || len == 0)
+        return;
+    queue_push(slot, data, len, false);
+}
+
+static void reply(ClientSlot *slot, const char *msg)
+{
+    slot_send(slot, msg, strlen(msg));
+}
+
+// 다른 사용자에게 밀어주는 메시지: 큐가 넘치면 느린 수신자 정책을 적용한다.
+static void slot_push(ClientSlot *slot, const char *data, size_t len)
+{
+    if (slot->sock <= 0 || slot->closing || len == 0)
+        return;
+
+    if (slot->outq.bytes + len > queue_limit)
+    {
+        if (slow_policy == SLOW_DISCONNECT)
+        {
+            qstats.slow_disconnects++;
+            slot->closing = true;
+            mark_dirty(slot);
+            return;
+        }
+        if (slow_policy == SLOW_DROP)
+        {
+            slot->dropped++;
+            slot->drop_unreported++;
+            qstats.dropped++;
+            return;
+        }
+
+        // SLOW_COALESCE: 아직 나가지 않은 브로드캐스트를 안내 한 줄로 대체
+        size_t before = slot->outq.bytes;
+        size_t n = outq_drop_pending(&slot->outq);
+        qstats.queued_bytes -= before - slot->outq.bytes;
+        slot->dropped += n;
+        qstats.coalesced += n;
+        if (n > 0)
+        {
+            char note[96];
+            int nl = snprintf(note, sizeof(note), "INFO: %zu messages skipped (slow connection)\n", n);
+            queue_push(slot, note, (size_t)nl, true);
+        }
+        if (slot->outq.bytes + len > queue_limit)
+        {
+            slot->dropped++;
+            slot->drop_unreported++;
+            qstats.dropped++;
+            return;
+        }
+    }
+    queue_push(slot, data, len, true);
+}
+
+// 소켓이 받아주는 만큼 보내고, 남으면 EPOLLOUT을 기다린다.
+static void slot_flush(ClientSlot *slot)
+{
+    size_t sent;
+    if (outq_send(&slot->outq, slot->sock, &sent) < 0)
+        slot->closing = true;
+    qstats.queued_bytes -= sent; // 오류 전에 일부 보냈어도 그만큼은 큐에서 빠짐
+
+    // 조용히 버린 브로드캐스트는 큐가 빠지고 나면 안내 한 줄로 알림
+    if (slot->drop_unreported > 0 && !slot->closing && slot->outq.bytes <= queue_limit / 2)
+    {
+        char note[96];
+        int nl = snprintf(note, sizeof(note), "INFO: %lu messages dropped (slow connection)\n",
+                          slot->drop_unreported);
+        slot->drop_unreported = 0;
+        queue_push(slot, note, (size_t)nl, false);
+    }
+
+    // 응답이 큐 상한을 넘게 쌓이면 이 연결의 명령 수신을 잠시 멈춘다
+    if (slot->outq.bytes > queue_limit)
+        slot->read_paused = true;
+    else if (slot->outq.bytes <= queue_limit / 2)
+        slot->read_paused = false;
+    slot_update_events(slot);
+}
+
+// 연결을 닫되 슬롯은 아직 반납하지 않는다. 같은 epoll_wait 묶음에 이 슬롯을 가리키는
+// 이벤트가 더 남아 있을 수 있어, 그 사이 accept 가 슬롯을 재사용하면 엉뚱한 연결을 건드린다.
+// sock 을 -1 로 두어 남은 이벤트는 무시되고, 반납은 묶음이 끝난 뒤 release_closed 에서 한다.
+static void slot_close(ClientSlot *slot)
+{
+    // 연결 종료 로그
+    printf("🔴 Client disconnected: %s:%d\n", slot->ip, slot->port);
+
+    epoll_ctl(epfd, EPOLL_CTL_DEL, slot->sock, NULL);
+    close(slot->sock);
+    slot->sock = -1;
+    slot->closing = true;
+    if (slot->dir_fd >= 0)
+        close(slot->dir_fd);
+    slot->dir_fd = -1;
+    qstats.queued_bytes -= slot->outq.bytes;
+    outq_clear(&slot->outq);
+    framer_free(&slot->in);
+    session_detach(slot); // 방 목록을 세션에 남겨 RESUME 으로 되살릴 수 있게 함
+    room_leave_all(slot);
+    slot->next_closed = closed_head;
+    closed_head = slot;
+}
+
+static void release_closed(void)
+{
+    while (closed_head)
+    {
+        ClientSlot *slot = closed_head;
+        closed_head = slot->next_closed;
+        registry_release(slot);
+    }
+}
+
+// 이벤트 하나를 처리한 뒤 쌓인 송신 데이터를 내보내고, 끊긴 연결을 정리한다.
+static void flush_dirty(void)
+{
+    while (dirty_head)
+    {
+        ClientSlot *slot = dirty_head;
+        dirty_head = slot->next_dirty;
+        slot->next_dirty = NULL;
+        slot->dirty = false;
+        if (slot->sock <= 0)
+            continue;
+        slot_flush(slot);
+        if (slot->closing)
+            slot_close(slot);
+    }
+}
 
 typedef struct
 {
-    int sock;
-    bool authenticated;
-    char username[64];
-    int permission_level;
-} ClientSlot;
+    const char *data;
+    size_t len;
+} FanoutMsg;
 
-void error_handling(char *message);
+static void fanout_visit(ClientSlot *member, void *ctx)
+{
+    FanoutMsg *m = ctx;
+    slot_push(member, m->data, m->len);
+}
+
+// 방 멤버에게만 전달: 비용이 전체 접속자 수가 아니라 방 크기에 비례
+static void room_broadcast(const char *room, const char *msg, const ClientSlot *sender)
+{
+    FanoutMsg m = {msg, strlen(msg)};
+    room_for_each(room, sender, fanout_visit, &m);
+}
 
-static ClientSlot clients[MAX_CLIENTS];
-pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static void listing_emit(void *ctx, const char *data, size_t len)
+{
+    slot_send((ClientSlot *)ctx, data, len);
+}
 
-void broadcast(const char *msg, int sender_sock)
+// LSPAGE <cursor> <count> [path]: 커서 위치부터 count 개 항목을 보내고
+// "ENDPAGE <다음 커서> <검증 토큰>"으로 끝냄. 다음 커서가 0이면 목록 끝.
+// 토큰은 읽기 전에 잡아 두므로 도중에 디렉토리가 바뀌면 다음 검증에서 걸러짐.
+// path 는 세션 디렉토리 기준 (공백 포함 가능)
+static void send_listing_page(ClientSlot *slot, const char *args)
 {
-    pthread_mutex_lock(&lock);
-    for (int i = 0; i < MAX_CLIENTS; i++)
+    long long cursor = 0, next = 0;
+    int count = 0, off = 0;
+    if (sscanf(args, "%lld %d %n", &cursor, &count, &off) < 2 || cursor < 0)
     {
-        if (clients[i].sock > 0 && clients[i].authenticated && clients[i].sock != sender_sock)
-            send(clients[i].sock, msg, strlen(msg), 0);
+        reply(slot, "ERR: usage LSPAGE <cursor> <count> [path]\n");
+        reply(slot, "ENDPAGE 0\n");
+        return;
     }
-    pthread_mutex_unlock(&lock);
+    if (count <= 0 || count > LIST_PAGE_MAX)
+        count = LIST_PAGE_MAX;
+
+    const char *path = off > 0 ? args + off : ".";
+    char token[LISTING_TOKEN_LEN] = "-";
+    int fd = listing_open(slot->dir_fd, path);
+    if (fd < 0 || !listing_token(fd, NULL, token) ||
+        listing_stream_page(fd, cursor, count, listing_emit, slot, &next) != 0)
+    {
+        reply(slot, "ERR: ls failed\n");
+        snprintf(token, sizeof(token), "-");
+        next = 0;
+    }
+    if (fd >= 0)
+        close(fd);
+
+    char end[48 + LISTING_TOKEN_LEN];
+    snprintf(end, sizeof(end), "ENDPAGE %lld %s\n", next, token);
+    reply(slot, end);
+}
+
+/* ============================================================
+   채팅 기록 (방별)
+   - 실시간 메시지와 기록 재전송 모두 "MSG <room> <ts> <user> <text>" 형식
+   - JOIN/HISTORY 응답은 "ENDHIST <room>" 으로 끝냄
+   ============================================================ */
+typedef struct
+{
+    ClientSlot *slot;
+    const char *room;
+} HistoryCtx;
+
+static void history_emit(void *ctx, const char *record, size_t len)
+{
+    HistoryCtx *h = ctx;
+    char line[ROOM_NAME_MAX + MAX_COMMAND_LEN + 128];
+    int n = snprintf(line, sizeof(line), "MSG %s %.*s\n", h->room, (int)len, record);
+    if (n > 0 && (size_t)n < sizeof(line))
+        slot_send(h->slot, line, (size_t)n);
+}
+
+static void end_history(ClientSlot *slot, const char *room)
+{
+    char end[ROOM_NAME_MAX + 16];
+    snprintf(end, sizeof(end), "ENDHIST %s\n", room);
+    reply(slot, end);
+}
+
+// JOIN <room> [since [seen]]: 방을 현재 방으로 정하고 since 이후(없으면 최근 몇 개)를 다시 보냄.
+// since 는 클라이언트가 받은 가장 큰 서버 ts, seen 은 그 ts 로 이미 받은 개수 (없으면 모두 받은 것으로 봄).
+// 이전 현재 방은 구독 해제 (다른 방을 계속 받으려면 SUB)
+static void handle_join(ClientSlot *slot, const char *args)
+{
+    char room[ROOM_NAME_MAX];
+    long long since = -1;
+    int seen = -1;
+    if (sscanf(args, "%255s %lld %d", room, &since, &seen) < 1 || !history_valid_room(room))
+    {
+        reply(slot, "ERR: usage JOIN <room> [since [seen]]\n");
+        return;
+    }
+    if (!room_subscribe(slot, room))
+    {
+        reply(slot, "ERR: too many rooms\n");
+        return;
+    }
+    if (slot->room[0] && strcmp(slot->room, room) != 0)
+        room_unsubscribe(slot, slot->room);
+    snprintf(slot->room, sizeof(slot->room), "%s", room);
+
+    HistoryCtx h = {slot, slot->room};
+    if (since >= 0)
+        history_since(room, since, seen, HISTORY_MAX_LINES, history_emit, &h);
+    else
+        history_last(room, HISTORY_JOIN_LINES, history_emit, &h);
+    end_history(slot, room);
+}
+
+// HISTORY <room> <N> [from to]: 최근 N 개, 또는 from~to 구간의 처음 N 개
+static void handle_history(ClientSlot *slot, const char *args)
+{
+    char room[ROOM_NAME_MAX];
+    int count = 0;
+    long long from = 0, to = 0;
+    int fields = sscanf(args, "%255s %d %lld %lld", room, &count, &from, &to);
+    if ((fields != 2 && fields != 4) || !history_valid_room(room))
+    {
+        reply(slot, "ERR: usage HISTORY <room> <N> [from to]\n");
+        return;
+    }
+    if (count <= 0 || count > HISTORY_MAX_LINES)
+        count = HISTORY_MAX_LINES;
+
+    HistoryCtx h = {slot, room};
+    int rc = fields == 4 ? history_range(room, from, to, count, history_emit, &h)
+                         : history_last(room, count, history_emit, &h);
+    if (rc < 0)
+        reply(slot, "ERR: history unavailable\n");
+    end_history(slot, room);
+}
+
+// 방 기록에 남기고 다른 사용자에게 전달
+static void post_message(ClientSlot *slot, const char *room, const char *text)
+{
+    const char *user = slot->username[0] ? slot->username : "client";
+    long long ts = history_append(room, (long long)time(NULL), user, text);
+    bool stored = ts >= 0;
+    if (!stored)
+        ts = (long long)time(NULL); // 기록에 실패해도 실시간 전달은 함
+
+    char msg[ROOM_NAME_MAX + MAX_COMMAND_LEN + 128];
+    snprintf(msg, sizeof(msg), "MSG %s %lld %s %s\n", room, ts, user, text);
+    room_broadcast(room, msg, slot);
+    // 보낸 사람은 MSG 를 받지 않으므로 기록된 ts 를 응답에 실어 JOIN since 계산에 쓰게 함
+    if (stored)
+        snprintf(msg, sizeof(msg), "ACK: message received ts=%lld\n", ts);
+    else
+        snprintf(msg, sizeof(msg), "ACK: message received\n");
+    reply(slot, msg);
+}
+
+static void send_stats(ClientSlot *slot)
+{
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "OK: clients=%d authed=%d rooms=%d sessions=%d queued_bytes=%zu peak_depth=%zu dropped=%lu coalesced=%lu slow_disconnects=%lu my_depth=%zu my_chunks=%zu\n",
+             registry_active_count(), registry_authenticated_count(), room_count(), session_count(),
+             qstats.queued_bytes, qstats.peak_depth, qstats.dropped, qstats.coalesced,
+             qstats.slow_disconnects, slot->outq.bytes, slot->outq.chunks);
+    reply(slot, buf);
 }
 
 static void trim_whitespace(char *s)
@@ -60,10 +427,15 @@ static void trim_whitespace(char *s)
     }
 }
 
-static void handle_command(ClientSlot *slot, const char *buf, const char *client_ip, int client_port)
+// 인자 없이 와도 사용법 오류를 돌려주도록 명령 이름만 확인
+static bool is_command(const char *buf, const char *name)
 {
-    char msg[1100];
+    size_t n = strlen(name);
+    return strncmp(buf, name, n) == 0 && (buf[n] == ' ' || buf[n] == '\0');
+}
 
+static void handle_command(ClientSlot *slot, const char *buf, const char *client_ip, int client_port)
+{
     if (!slot->authenticated)
     {
         if (buf[0] == '\0')
@@ -77,20 +449,51 @@ static void handle_command(ClientSlot *slot, const char *buf, const char *client
         AuthResult res = AUTH_INVALID;
 
         int fields = sscanf(buf, "%15s %63s %79s", cmd, user, pw_hash);
+        if (fields == 2 && strcasecmp(cmd, "RESUME") == 0)
+        {
+            // RESUME <token>: 비밀번호 확인 없이 세션의 신원/권한/방을 복원
+            ClientSlot *old;
+            if (session_resume(slot, user, &old))
+            {
+                if (old)
+                {
+                    // 같은 세션의 이전 연결은 알리고 닫음 (flush_dirty 에서 남은 송신 후 종료)
+                    reply(old, "INFO: session resumed from another connection\n");
+                    old->closing = true;
+                    mark_dirty(old);
+                }
+                registry_set_authenticated(slot);
+                printf("👤 User resumed: %s (%s:%d)\n", slot->username, client_ip, client_port);
+                char ok[128];
+                snprintf(ok, sizeof(ok), "OK: resumed %s session=%s\n", slot->username, slot->session);
+                reply(slot, ok);
+            }
+            else
+                reply(slot, "ERR: invalid session\n");
+            return;
+        }
         if (fields == 3 && strcasecmp(cmd, "LOGIN") == 0)
             res = verify_credentials(user, pw_hash, &perm, &remaining);
 
         if (res == AUTH_OK)
         {
-            slot->authenticated = true;
+            registry_set_authenticated(slot);
             snprintf(slot->username, sizeof(slot->username), "%s", user);
             slot->permission_level = perm;
             printf("👤 User logged in: %s (%s:%d)\n", user, client_ip, client_port);
-            send(slot->sock, "OK: login successful\n", strlen("OK: login successful\n"), 0);
+            // 다음 접속 때 RESUME 으로 쓸 세션 토큰을 함께 알려 줌
+            if (session_create(slot))
+            {
+                char ok[128];
+                snprintf(ok, sizeof(ok), "OK: login successful session=%s ttl=%d\n", slot->session, session_ttl());
+                reply(slot, ok);
+            }
+            else
+                reply(slot, "OK: login successful\n");
         }
         else if (res == AUTH_LOCKED)
         {
-            send(slot->sock, "ERR: account locked\n", strlen("ERR: account locked\n"), 0);
+            reply(slot, "ERR: account locked\n");
         }
         else if (fields == 3)
         {
@@ -98,116 +501,245 @@ static void handle_command(ClientSlot *slot, const char *buf, const char *client
             {
                 char err[80];
                 snprintf(err, sizeof(err), "ERR: invalid credentials (%d tries left)\n", remaining);
-                send(slot->sock, err, strlen(err), 0);
+                reply(slot, err);
             }
             else
             {
-                send(slot->sock, "ERR: invalid credentials\n", strlen("ERR: invalid credentials\n"), 0);
+                reply(slot, "ERR: invalid credentials\n");
             }
         }
         else
         {
-            send(slot->sock, "ERR: please login first\n", strlen("ERR: please login first\n"), 0);
+            reply(slot, "ERR: please login first\n");
         }
         return;
     }
 
     // ========== 명령어 처리 ==========
+    // 파일시스템 명령은 프로세스 cwd가 아니라 세션 디렉토리 fd 기준으로 처리
     if (strncmp(buf, "cd ", 3) == 0)
     {
-        if (chdir(buf + 3) == 0)
-            send(slot->sock, "OK: changed directory\n", strlen("OK: changed directory\n"), 0);
+        int fd = openat(slot->dir_fd, buf + 3, O_PATH | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0)
+        {
+            close(slot->dir_fd);
+            slot->dir_fd = fd;
+            reply(slot, "OK: changed directory\n");
+        }
         else
-            send(slot->sock, "ERR: invalid path\n", strlen("ERR: invalid path\n"), 0);
+            reply(slot, "ERR: invalid path\n");
     }
     else if (strncmp(buf, "mkdir ", 6) == 0)
     {
-        if (mkdir(buf + 6, 0755) == 0)
-            send(slot->sock, "OK: dir created\n", strlen("OK: dir created\n"), 0);
+        if (mkdirat(slot->dir_fd, buf + 6, 0755) == 0)
+            reply(slot, "OK: dir created\n");
+        else
+            reply(slot, "ERR: mkdir failed\n");
+    }
+    else if (strcmp(buf, "PWD") == 0)
+    {
+        char link[64], path[PATH_MAX], line[PATH_MAX + 8];
+        snprintf(link, sizeof(link), "/proc/self/fd/%d", slot->dir_fd);
+        ssize_t n = readlink(link, path, sizeof(path) - 1);
+        if (n > 0)
+        {
+            path[n] = '\0';
+            snprintf(line, sizeof(line), "OK: %s\n", path);
+            reply(slot, line);
+        }
         else
-            send(slot->sock, "ERR: mkdir failed\n", strlen("ERR: mkdir failed\n"), 0);
+            reply(slot, "ERR: pwd failed\n");
+    }
+    else if (strncmp(buf, "LSPAGE ", 7) == 0)
+    {
+        send_listing_page(slot, buf + 7);
+    }
+    else if (strncmp(buf, "STAT ", 5) == 0)
+    {
+        // 클라이언트 목록 캐시 검증용: 목록을 다시 받지 않고 토큰만 비교
+        char token[LISTING_TOKEN_LEN], line[LISTING_TOKEN_LEN + 8];
+        if (listing_token(slot->dir_fd, buf + 5, token))
+        {
+            snprintf(line, sizeof(line), "OK: %s\n", token);
+            reply(slot, line);
+        }
+        else
+            reply(slot, "ERR: stat failed\n");
+    }
+    else if (strcmp(buf, "STATS") == 0)
+    {
+        send_stats(slot);
+    }
+    else if (is_command(buf, "JOIN"))
+    {
+        handle_join(slot, buf + 4);
+    }
+    else if (is_command(buf, "HISTORY"))
+    {
+        handle_history(slot, buf + 7);
+    }
+    else if (is_command(buf, "SUB") || is_command(buf, "UNSUB"))
+    {
+        // SUB/UNSUB <room>: 현재 방은 그대로 두고 다른 방 메시지 수신 여부만 바꿈
+        bool sub = buf[0] == 'S';
+        const char *room = buf + (sub ? 3 : 5);
+        while (*room == ' ')
+            room++;
+        if (!history_valid_room(room))
+            reply(slot, sub ? "ERR: usage SUB <room>\n" : "ERR: usage UNSUB <room>\n");
+        else if (sub)
+            reply(slot, room_subscribe(slot, room) ? "OK: subscribed\n" : "ERR: too many rooms\n");
+        else
+        {
+            bool was = room_unsubscribe(slot, room);
+            if (strcmp(slot->room, room) == 0)
+                slot->room[0] = '\0';
+            reply(slot, was ? "OK: unsubscribed\n" : "ERR: not subscribed\n");
+        }
+    }
+    else if (is_command(buf, "SAY"))
+    {
+        // SAY <room> <text>
+        char room[ROOM_NAME_MAX];
+        int off = 0;
+        if (sscanf(buf + 3, "%255s %n", room, &off) == 1 && off > 0 && buf[3 + off] && history_valid_room(room))
+        {
+            printf("[%s:%d][%s@%s] %s\n", client_ip, client_port, slot->username, room, buf + 3 + off);
+            post_message(slot, room, buf + 3 + off);
+        }
+        else
+            reply(slot, "ERR: usage SAY <room> <text>\n");
     }
     else if (strncmp(buf, "ls", 2) == 0)
     {
-        // [수정됨] ls 처리 및 ENDLS 마커 전송 로직
-        char tmpbuf[1024];
-        FILE *fp = popen("ls -al", "r");
-        
-        if (!fp)
+        // 프로세스를 띄우지 않고 getdents64/fstatat 로 만든 목록을 송신 큐로 바로 흘려보냄
+        // 응답은 버릴 수 없는 큐로 가므로 한 번에 LSPAGE 한 페이지 분량까지만 보내고, 나머지는 LSPAGE 로 받게 함
+        long long next = 0;
+        int fd = listing_open(slot->dir_fd, ".");
+        if (fd < 0 || listing_stream_page(fd, 0, LIST_PAGE_MAX, listing_emit, slot, &next) != 0)
         {
-            // popen 실패 시
             const char *err = "ERR: ls failed\n";
-            send(slot->sock, err, strlen(err), 0);
+            reply(slot, err);
         }
-        else
+        else if (next != 0)
         {
-            // 실행 결과 전송
-            while (fgets(tmpbuf, sizeof(tmpbuf), fp))
-            {
-                send(slot->sock, tmpbuf, strlen(tmpbuf), 0);
-            }
-            pclose(fp);
+            char more[96];
+            snprintf(more, sizeof(more), "INFO: first %d entries only, continue with LSPAGE %lld %d\n",
+                     LIST_PAGE_MAX, next, LIST_PAGE_MAX);
+            reply(slot, more);
         }
-        
+        if (fd >= 0)
+            close(fd);
+
         // [중요] 클라이언트가 대기 중인 종료 마커 전송
         const char *end = "ENDLS\n";
-        send(slot->sock, end, strlen(end), 0);
+        reply(slot, end);
     }
     else
     {
-        // 일반 메시지: 서버 콘솔 출력 + 다른 클라이언트에게 브로드캐스트
+        // 일반 메시지: 서버 콘솔 출력 + 현재 방(JOIN 전이면 기본 방)으로 전달
         printf("[%s:%d][%s] %s\n", client_ip, client_port, slot->username[0] ? slot->username : "?", buf);
-        snprintf(msg, sizeof(msg), "%s: %s\n", slot->username[0] ? slot->username : "client", buf);
-        broadcast(msg, slot->sock);
-        send(slot->sock, "ACK: message received\n", strlen("ACK: message received\n"), 0);
+        post_message(slot, slot->room[0] ? slot->room : DEFAULT_ROOM, buf);
     }
 }
 
-void *client_handler(void *arg)
+// 수신 버퍼에 쌓인 완성된 줄을 모두 명령으로 처리한다. 한 번의 recv에 여러 명령이
+// 들어 있어도, 명령이 여러 recv로 쪼개져 와도 줄 단위로 정확히 나뉜다.
+static void slot_handle_input(ClientSlot *slot)
 {
-    ClientSlot *slot = (ClientSlot *)arg;
-    int sock = slot->sock;
-
-    struct sockaddr_in addr;
-    socklen_t len = sizeof(addr);
-    getpeername(sock, (struct sockaddr *)&addr, &len);
-
-    char client_ip[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &addr.sin_addr, client_ip, sizeof(client_ip));
-    int client_port = ntohs(addr.sin_port);
-
-    printf("🟢 Client connected: %s:%d\n", client_ip, client_port);
-
-    char buf[1024];
-    const char *banner = "INFO: login required\n";
-    send(sock, banner, strlen(banner), 0);
+    char *line;
+    while (!slot->closing && (line = framer_next(&slot->in)))
+    {
+        trim_whitespace(line);
+        handle_command(slot, line, slot->ip, slot->port);
+    }
+    // 너무 긴 줄은 잘린 앞부분을 실행하지 않고 버렸음을 알림
+    if (!slot->closing && framer_take_dropped(&slot->in))
+        reply(slot, "ERR: line too long\n");
+}
 
-    while (1)
+// 읽을 수 있는 만큼 읽는다. 연결이 끊겼으면 false.
+static bool slot_read(ClientSlot *slot)
+{
+    for (;;)
     {
-        ssize_t n = recv(sock, buf, sizeof(buf) - 1, 0);
-        if (n <= 0)
-            break; // 클라이언트 종료 또는 오류
-        buf[n] = '\0';
-        trim_whitespace(buf);
-        handle_command(slot, buf, client_ip, client_port);
+        size_t room;
+        char *space = framer_space(&slot->in, &room);
+        if (!space)
+            return false;
+        ssize_t n = recv(slot->sock, space, room, 0);
+        if (n > 0)
+        {
+            framer_commit(&slot->in, (size_t)n);
+            slot_handle_input(slot);
+            if (slot->closing)
+                return false;
+            if (slot->outq.bytes > queue_limit)
+                return true; // 응답이 밀렸으면 flush 후 다시 읽는다
+            continue;
+        }
+        if (n == 0)
+            return false; // 클라이언트 종료
+        if (errno == EINTR)
+            continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
     }
+}
 
-    // 연결 종료 로그
-    printf("🔴 Client disconnected: %s:%d\n", client_ip, client_port);
+static void accept_clients(int serv_sock)
+{
+    for (;;)
+    {
+        struct sockaddr_in clnt_addr;
+        socklen_t clnt_addr_size = sizeof(clnt_addr);
+        int clnt_sock = accept(serv_sock, (struct sockaddr *)&clnt_addr, &clnt_addr_size);
+        if (clnt_sock == -1)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                perror("accept() error");
+            return;
+        }
+
+        // 🔗 클라이언트 접속 로그
+        printf("🔗 New client connected from %s:%d\n",
+               inet_ntoa(clnt_addr.sin_addr),
+               ntohs(clnt_addr.sin_port));
+
+        ClientSlot *target_slot = registry_alloc();
+        if (!target_slot)
+        {
+            const char *msg = "ERR: server busy\n";
+            send(clnt_sock, msg, strlen(msg), MSG_NOSIGNAL);
+            close(clnt_sock);
+            continue;
+        }
 
-    close(sock);
-    pthread_mutex_lock(&lock);
-    for (int i = 0; i < MAX_CLIENTS; i++)
-        if (clients[i].sock == sock)
+        set_nonblocking(clnt_sock);
+        target_slot->sock = clnt_sock;
+        target_slot->dir_fd = openat(root_fd, ".", O_PATH | O_DIRECTORY | O_CLOEXEC);
+        framer_init(&target_slot->in, MAX_COMMAND_LEN);
+        inet_ntop(AF_INET, &clnt_addr.sin_addr, target_slot->ip, sizeof(target_slot->ip));
+        target_slot->port = ntohs(clnt_addr.sin_port);
+
+        struct epoll_event ev = {0};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = target_slot;
+        target_slot->ev_mask = ev.events;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, clnt_sock, &ev) == -1)
         {
-            clients[i].sock = 0;
-            clients[i].authenticated = false;
-            clients[i].username[0] = '\0';
-            clients[i].permission_level = 0;
+            close(clnt_sock);
+            if (target_slot->dir_fd >= 0)
+                close(target_slot->dir_fd);
+            framer_free(&target_slot->in);
+            registry_release(target_slot);
+            continue;
         }
-    pthread_mutex_unlock(&lock);
 
-    return NULL;
+        printf("🟢 Client connected: %s:%d\n", target_slot->ip, target_slot->port);
+        reply(target_slot, "INFO: login required\n");
+    }
 }
 
 int main(int argc, char *argv[])
@@ -216,11 +748,36 @@ int main(int argc, char *argv[])
     char host[256] = "127.0.0.1";
     int port = 5050;
 
+    // 동시 접속 상한: TALKSHELL_MAX_CLIENTS 환경변수 (기본 DEFAULT_MAX_CLIENTS)
+    const char *max_env = getenv("TALKSHELL_MAX_CLIENTS");
+    registry_init(max_env ? atoi(max_env) : 0);
+
+    // 느린 수신자 정책: TALKSHELL_SLOW_POLICY=drop|coalesce|disconnect, TALKSHELL_QUEUE_LIMIT=바이트
+    const char *policy_env = getenv("TALKSHELL_SLOW_POLICY");
+    if (policy_env && strcasecmp(policy_env, "coalesce") == 0)
+        slow_policy = SLOW_COALESCE;
+    else if (policy_env && strcasecmp(policy_env, "disconnect") == 0)
+        slow_policy = SLOW_DISCONNECT;
+    const char *limit_env = getenv("TALKSHELL_QUEUE_LIMIT");
+    if (limit_env && atol(limit_env) > 0)
+        queue_limit = (size_t)atol(limit_env);
+
     if (!auth_init())
     {
         fprintf(stderr, "[WARN] Failed to initialize authentication state.\n");
     }
 
+    // 세션 유지 시간: TALKSHELL_SESSION_TTL=초 (기본 SESSION_TTL_DEFAULT)
+    const char *ttl_env = getenv("TALKSHELL_SESSION_TTL");
+    session_init(ttl_env ? atoi(ttl_env) : 0);
+
+    // 방별 채팅 기록 위치: TALKSHELL_HISTORY_DIR (기본 ./.talkshell_history)
+    const char *history_env = getenv("TALKSHELL_HISTORY_DIR");
+    if (!history_init(history_env ? history_env : ".talkshell_history"))
+    {
+        fprintf(stderr, "[WARN] Chat history disabled (cannot open history directory).\n");
+    }
+
     // 그 외에 다른 호스트 주소랑 포트를 사용자가 입력했다면, 그 주소:포트로 기본경로 덮어쓰기
     if (argc >= 3)
     { 
@@ -255,11 +812,8 @@ int main(int argc, char *argv[])
     }
 
     int serv_sock;
-    int clnt_sock;
 
     struct sockaddr_in serv_addr;
-    struct sockaddr_in clnt_addr;
-    socklen_t clnt_addr_size;
 
     // [수정됨] ✅ 서버 시작 시 /home 이동 제거 (현재 디렉토리 유지)
     // (void)chdir("/home"); 
@@ -267,6 +821,9 @@ int main(int argc, char *argv[])
     if (getcwd(cwd, sizeof(cwd)) != NULL) {
         printf("📁 Server running at: %s\n", cwd);
     }
+    root_fd = open(".", O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd == -1)
+        error_handling("open(\".\") error");
 
     /* 서버 소켓(리스닝 소켓) 생성 */
     serv_sock = socket(AF_INET, SOCK_STREAM, 0);
@@ -286,50 +843,61 @@ int main(int argc, char *argv[])
     if (bind(serv_sock, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) == -1)
         error_handling("bind() error");
 
-    if (listen(serv_sock, 5) == -1)
+    if (listen(serv_sock, SOMAXCONN) == -1)
         error_handling("listen() error");
 
-    printf("🚀 ChatOps server listening on port %d...\n", port);
+    printf("🚀 ChatOps server listening on port %d (max %d clients)...\n", port, registry_max_clients());
+
+    set_nonblocking(serv_sock);
+    epfd = epoll_create1(0);
+    if (epfd == -1)
+        error_handling("epoll_create1() error");
 
+    // 리스닝 소켓은 data.ptr == NULL 로 구분
+    struct epoll_event lev = {0};
+    lev.events = EPOLLIN;
+    lev.data.ptr = NULL;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, serv_sock, &lev) == -1)
+        error_handling("epoll_ctl() error");
+
+    // 단일 스레드 이벤트 루프: 모든 연결을 epoll 하나로 처리
+    struct epoll_event events[MAX_EVENTS];
     while (1)
     {
-        clnt_addr_size = sizeof(clnt_addr);
-        clnt_sock = accept(serv_sock, (struct sockaddr *)&clnt_addr, &clnt_addr_size);
-        if (clnt_sock == -1)
-            error_handling("accept() error");
-
-        // 🔗 클라이언트 접속 로그
-        printf("🔗 New client connected from %s:%d\n",
-               inet_ntoa(clnt_addr.sin_addr),
-               ntohs(clnt_addr.sin_port));
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            error_handling("epoll_wait() error");
+        }
 
-        pthread_mutex_lock(&lock);
-        ClientSlot *target_slot = NULL;
-        for (int i = 0; i < MAX_CLIENTS; i++)
-            if (clients[i].sock == 0)
+        for (int i = 0; i < n; i++)
+        {
+            ClientSlot *slot = events[i].data.ptr;
+            if (!slot)
             {
-                clients[i].sock = clnt_sock;
-                clients[i].authenticated = false;
-                clients[i].username[0] = '\0';
-                target_slot = &clients[i];
-                break;
+                accept_clients(serv_sock);
             }
-        pthread_mutex_unlock(&lock);
-
-        if (!target_slot)
-        {
-            const char *msg = "ERR: server busy\n";
-            send(clnt_sock, msg, strlen(msg), 0);
-            close(clnt_sock);
-            continue;
+            else if (slot->sock > 0)
+            {
+                uint32_t e = events[i].events;
+                bool alive = !(e & EPOLLERR);
+                if (alive && (e & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+                    alive = slot_read(slot);
+                if (alive && (e & EPOLLOUT))
+                    slot_flush(slot);
+                if (!alive || slot->closing)
+                    slot->closing = true;
+                if (slot->closing && !slot->dirty)
+                    slot_close(slot);
+            }
+            flush_dirty();
         }
-
-        pthread_t tid;
-        pthread_create(&tid, NULL, client_handler, target_slot);
-        pthread_detach(tid);
+        release_closed();
     }
 
-    close(clnt_sock);
+    close(epfd);
     close(serv_sock);
     return 0;
 }
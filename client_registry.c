@@ -0,0 +1,134 @@
+#include "client_registry.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+   연결 레지스트리
+   - 슬롯은 개별 할당되어 주소가 바뀌지 않음 (epoll data.ptr로 사용)
+   - 빈 슬롯 번호는 스택으로 관리해 할당/해제가 O(1)
+   - 인증된 연결은 별도의 이중 연결 리스트로 묶어 브로드캐스트 비용이
+     전체 테이블 크기가 아니라 인증된 수신자 수에 비례하도록 함
+   ============================================================ */
+static ClientSlot **slots = NULL; // 인덱스 → 슬롯
+static int slot_cap = 0;          // 지금까지 만든 슬롯 수
+static int *free_ids = NULL;      // 비어 있는 슬롯 번호 스택
+static int free_count = 0;
+static int active_count = 0;
+static int max_clients = DEFAULT_MAX_CLIENTS;
+
+static ClientSlot *auth_head = NULL;
+static int auth_count = 0;
+
+void registry_init(int limit)
+{
+    max_clients = limit > 0 ? limit : DEFAULT_MAX_CLIENTS;
+}
+
+static bool registry_grow(void)
+{
+    int cap = slot_cap ? slot_cap * 2 : 16;
+    if (cap > max_clients)
+        cap = max_clients;
+    if (cap <= slot_cap)
+        return false;
+
+    ClientSlot **ns = realloc(slots, sizeof(*ns) * cap);
+    if (!ns)
+        return false;
+    slots = ns;
+    int *nf = realloc(free_ids, sizeof(*nf) * cap);
+    if (!nf)
+        return false;
+    free_ids = nf;
+
+    // 새 번호는 작은 번호부터 꺼내지도록 역순으로 쌓는다
+    for (int i = cap - 1; i >= slot_cap; i--)
+    {
+        slots[i] = NULL;
+        free_ids[free_count++] = i;
+    }
+    slot_cap = cap;
+    return true;
+}
+
+ClientSlot *registry_alloc(void)
+{
+    if (free_count == 0 && !registry_grow())
+        return NULL;
+
+    int id = free_ids[--free_count];
+    ClientSlot *slot = slots[id];
+    if (!slot)
+    {
+        slot = malloc(sizeof(*slot));
+        if (!slot)
+        {
+            free_ids[free_count++] = id;
+            return NULL;
+        }
+        slots[id] = slot;
+    }
+    memset(slot, 0, sizeof(*slot));
+    slot->id = id;
+    active_count++;
+    return slot;
+}
+
+static void auth_unlink(ClientSlot *slot)
+{
+    if (slot->auth_prev)
+        slot->auth_prev->auth_next = slot->auth_next;
+    else if (auth_head == slot)
+        auth_head = slot->auth_next;
+    else
+        return; // 목록에 없음
+    if (slot->auth_next)
+        slot->auth_next->auth_prev = slot->auth_prev;
+    slot->auth_prev = slot->auth_next = NULL;
+    auth_count--;
+}
+
+void registry_release(ClientSlot *slot)
+{
+    if (!slot)
+        return;
+    auth_unlink(slot);
+    int id = slot->id;
+    memset(slot, 0, sizeof(*slot));
+    slot->id = id;
+    free_ids[free_count++] = id;
+    active_count--;
+}
+
+void registry_set_authenticated(ClientSlot *slot)
+{
+    if (slot->authenticated)
+        return;
+    slot->authenticated = true;
+    slot->auth_prev = NULL;
+    slot->auth_next = auth_head;
+    if (auth_head)
+        auth_head->auth_prev = slot;
+    auth_head = slot;
+    auth_count++;
+}
+
+ClientSlot *registry_authenticated(void)
+{
+    return auth_head;
+}
+
+int registry_active_count(void)
+{
+    return active_count;
+}
+
+int registry_authenticated_count(void)
+{
+    return auth_count;
+}
+
+int registry_max_clients(void)
+{
+    return max_clients;
+}
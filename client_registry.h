@@ -0,0 +1,57 @@
+#ifndef CLIENT_REGISTRY_H
+#define CLIENT_REGISTRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <netinet/in.h>
+
+#include "line_framer.h"
+#include "out_queue.h"
+
+#define MAX_COMMAND_LEN 1023
+#define DEFAULT_MAX_CLIENTS 4096
+#define ROOM_NAME_MAX 256         // 방 이름 최대 길이 (NUL 포함, 기록 저장소와 같음)
+#define SESSION_TOKEN_LEN 32      // 세션 토큰 (16바이트 난수의 16진수)
+
+typedef struct ClientSlot
+{
+    int sock;
+    bool authenticated;
+    char username[64];
+    int permission_level;
+    char session[SESSION_TOKEN_LEN + 1]; // 로그인/RESUME 으로 받은 세션 토큰 (없으면 빈 문자열)
+
+    char ip[INET_ADDRSTRLEN];
+    int port;
+    int dir_fd;               // 세션별 작업 디렉토리 (cd/mkdir/ls 의 기준, *at 호출용)
+    char room[ROOM_NAME_MAX]; // 마지막으로 JOIN 한 방 (말머리 없는 메시지의 대상)
+    struct RoomSub *subs;     // 구독 중인 방 (room_manager 가 관리)
+    int sub_count, sub_cap;
+
+    // 논블로킹 소켓용 연결별 버퍼
+    LineFramer in;            // 아직 개행을 받지 못한 명령 조각
+    OutQueue outq;            // 소켓이 받아주지 못한 송신 데이터
+    unsigned int ev_mask;     // 현재 epoll에 등록된 이벤트
+    bool read_paused;         // 송신 큐가 넘쳐 수신을 멈춘 상태
+    unsigned long dropped;    // 느린 수신자 정책으로 버린 브로드캐스트 수
+    unsigned long drop_unreported; // 버렸지만 아직 INFO 로 알리지 않은 수
+    bool dirty;               // 이번 이벤트 처리 후 flush 필요
+    bool closing;             // 송신 오류 등으로 종료 예정
+    struct ClientSlot *next_dirty;
+    struct ClientSlot *next_closed; // 닫았지만 아직 registry_release 하지 않은 연결 목록
+
+    // 레지스트리 내부용
+    int id;                                // 슬롯 테이블 인덱스
+    struct ClientSlot *auth_prev, *auth_next; // 인증된 연결 목록
+} ClientSlot;
+
+void registry_init(int max_clients);     // max_clients <= 0 이면 기본값
+ClientSlot *registry_alloc(void);        // O(1), 상한에 도달하면 NULL
+void registry_release(ClientSlot *slot); // O(1), 슬롯은 재사용을 위해 보관
+void registry_set_authenticated(ClientSlot *slot);
+ClientSlot *registry_authenticated(void); // 인증된 연결 목록의 첫 항목 (auth_next로 순회)
+int registry_active_count(void);
+int registry_authenticated_count(void);
+int registry_max_clients(void);
+
+#endif
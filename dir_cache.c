@@ -0,0 +1,120 @@
+#include "dir_cache.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+/* ============================================================
+   디렉토리 목록 LRU 캐시
+   - 경로별로 파싱된 목록을 그대로 보관 (문자열 복사 없이 소유권 이동)
+   - 꺼낼 때 서버 토큰(장치:inode:mtime)이 같아야만 재사용
+   - 항목 수가 작아서 선형 탐색 + 사용 순서 카운터로 충분
+   ============================================================ */
+typedef struct {
+    bool used;
+    char kind;
+    char path[PATH_MAX];
+    CachedList list;
+    unsigned long last_use;
+} CacheEntry;
+
+static CacheEntry entries[DIR_CACHE_CAP];
+static unsigned long use_clock = 0;
+
+static void list_free(CachedList *l)
+{
+    free(l->items);
+    pool_free(&l->pool);
+    memset(l, 0, sizeof(*l));
+}
+
+static CacheEntry *find(char kind, const char *path)
+{
+    for (int i = 0; i < DIR_CACHE_CAP; i++)
+        if (entries[i].used && entries[i].kind == kind && strcmp(entries[i].path, path) == 0)
+            return &entries[i];
+    return NULL;
+}
+
+static void evict(CacheEntry *e)
+{
+    list_free(&e->list);
+    e->used = false;
+}
+
+void dir_cache_put(char kind, const char *path, CachedList *list)
+{
+    if (!path || !*path || !list->token[0])
+    {
+        list_free(list);
+        return;
+    }
+
+    CacheEntry *e = find(kind, path);
+    if (e)
+        evict(e);
+    else
+    {
+        // 빈 칸이 없으면 가장 오래 안 쓴 항목 자리를 씀
+        e = &entries[0];
+        for (int i = 0; i < DIR_CACHE_CAP; i++)
+        {
+            if (!entries[i].used)
+            {
+                e = &entries[i];
+                break;
+            }
+            if (entries[i].last_use < e->last_use)
+                e = &entries[i];
+        }
+        if (e->used)
+            evict(e);
+    }
+
+    e->used = true;
+    e->kind = kind;
+    snprintf(e->path, sizeof(e->path), "%s", path);
+    e->list = *list;
+    e->last_use = ++use_clock;
+    memset(list, 0, sizeof(*list));
+}
+
+bool dir_cache_take(char kind, const char *path, const char *token, CachedList *out)
+{
+    CacheEntry *e = find(kind, path);
+    if (!e)
+        return false;
+    if (!token || strcmp(e->list.token, token) != 0)
+    {
+        evict(e); // 디렉토리가 바뀜
+        return false;
+    }
+    *out = e->list;
+    memset(&e->list, 0, sizeof(e->list));
+    e->used = false;
+    return true;
+}
+
+bool dir_cache_take_at(char kind, const char *path, long long cursor, const char *token, CachedList *out)
+{
+    CacheEntry *e = find(kind, path);
+    if (!e || e->list.cursor != cursor)
+        return false;
+    return dir_cache_take(kind, path, token, out);
+}
+
+bool dir_cache_has(char kind, const char *path)
+{
+    return find(kind, path) != NULL;
+}
+
+void dir_cache_clear(void)
+{
+    for (int i = 0; i < DIR_CACHE_CAP; i++)
+        if (entries[i].used)
+            evict(&entries[i]);
+}
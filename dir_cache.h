@@ -0,0 +1,29 @@
+#ifndef DIR_CACHE_H
+#define DIR_CACHE_H
+
+#include <stdbool.h>
+#include "str_pool.h"
+
+#define DIR_CACHE_CAP 32   // 보관할 목록 수 (넘치면 가장 오래 안 쓴 것부터 버림)
+#define DIR_TOKEN_LEN 64
+
+// 파싱이 끝난 목록 하나. 캐시에 넣으면 items/pool 소유권이 캐시로 넘어감
+typedef struct {
+    char **items;      // 이름은 pool 안을 가리킴
+    int count, cap;
+    int selected;      // 떠날 때의 선택 위치
+    long long cursor;  // 이어 받을 페이지 위치
+    bool more;
+    char token[DIR_TOKEN_LEN]; // 서버가 준 검증 토큰
+    StrPool pool;
+} CachedList;
+
+// kind: 'd' = 디렉토리 목록, 'f' = 파일 목록
+void dir_cache_put(char kind, const char *path, CachedList *list);     // list 내용은 비워짐
+bool dir_cache_take(char kind, const char *path, const char *token, CachedList *out); // 토큰이 같을 때만 꺼냄
+// 같은 목록 스냅샷(token)을 cursor 지점까지 받아 둔 항목만 꺼냄 (한 응답을 두 목록에 나눠 담을 때)
+bool dir_cache_take_at(char kind, const char *path, long long cursor, const char *token, CachedList *out);
+bool dir_cache_has(char kind, const char *path);
+void dir_cache_clear(void);
+
+#endif
@@ -0,0 +1,146 @@
+#define _GNU_SOURCE
+#include "dir_listing.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define DENTS_BUF_SIZE (64 * 1024)
+#define EMIT_BUF_SIZE (64 * 1024)
+
+/* ============================================================
+   프로세스 내 디렉토리 목록 엔진
+   - popen("ls -al") 대신 getdents64 + fstatat 로 직접 읽음
+   - 결과는 ls -al 과 같은 열 구성으로 만들어 기존 클라이언트 파서와 호환
+     (소유자/그룹은 이름 조회 없이 숫자로, 순서는 디렉토리 순서 그대로)
+   ============================================================ */
+struct linux_dirent64
+{
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+int listing_open(int base_fd, const char *path)
+{
+    if (!path || !*path)
+        path = ".";
+    return openat(base_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+
+bool listing_token(int dir_fd, const char *path, char out[LISTING_TOKEN_LEN])
+{
+    struct stat st;
+    int rc = path ? fstatat(dir_fd, path, &st, 0) : fstat(dir_fd, &st);
+    if (rc != 0 || !S_ISDIR(st.st_mode))
+        return false;
+    snprintf(out, LISTING_TOKEN_LEN, "%lx:%lx:%lld.%09ld",
+             (unsigned long)st.st_dev, (unsigned long)st.st_ino,
+             (long long)st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+    return true;
+}
+
+static void format_mode(mode_t m, char out[11])
+{
+    out[0] = S_ISDIR(m) ? 'd' : S_ISLNK(m) ? 'l' : S_ISCHR(m) ? 'c' : S_ISBLK(m) ? 'b'
+             : S_ISFIFO(m) ? 'p' : S_ISSOCK(m) ? 's' : '-';
+    out[1] = (m & S_IRUSR) ? 'r' : '-';
+    out[2] = (m & S_IWUSR) ? 'w' : '-';
+    out[3] = (m & S_ISUID) ? ((m & S_IXUSR) ? 's' : 'S') : ((m & S_IXUSR) ? 'x' : '-');
+    out[4] = (m & S_IRGRP) ? 'r' : '-';
+    out[5] = (m & S_IWGRP) ? 'w' : '-';
+    out[6] = (m & S_ISGID) ? ((m & S_IXGRP) ? 's' : 'S') : ((m & S_IXGRP) ? 'x' : '-');
+    out[7] = (m & S_IROTH) ? 'r' : '-';
+    out[8] = (m & S_IWOTH) ? 'w' : '-';
+    out[9] = (m & S_ISVTX) ? ((m & S_IXOTH) ? 't' : 'T') : ((m & S_IXOTH) ? 'x' : '-');
+    out[10] = '\0';
+}
+
+size_t listing_format_entry(int dir_fd, const char *name, char *out, size_t size)
+{
+    struct stat st;
+    if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        return 0;
+
+    char perms[11];
+    format_mode(st.st_mode, perms);
+
+    // ls와 같이 6개월 넘은 항목은 시각 대신 연도 표시
+    char when[16];
+    struct tm tm;
+    localtime_r(&st.st_mtime, &tm);
+    time_t now = time(NULL);
+    if (st.st_mtime > now - 182 * 24 * 3600 && st.st_mtime <= now + 3600)
+        strftime(when, sizeof(when), "%b %e %H:%M", &tm);
+    else
+        strftime(when, sizeof(when), "%b %e  %Y", &tm);
+
+    int n = snprintf(out, size, "%s %lu %u %u %lld %s %s\n",
+                     perms, (unsigned long)st.st_nlink, (unsigned)st.st_uid, (unsigned)st.st_gid,
+                     (long long)st.st_size, when, name);
+    if (n < 0 || (size_t)n >= size)
+        return 0;
+    return (size_t)n;
+}
+
+int listing_stream_page(int dir_fd, long long cursor, int max_entries,
+                        ListingEmit emit, void *ctx, long long *next_cursor)
+{
+    static char dents[DENTS_BUF_SIZE]; // 스택 대신 정적 버퍼: 재진입 불가 (dir_listing.h 참고)
+    static char out[EMIT_BUF_SIZE];
+    size_t used = 0;
+    int sent = 0;
+    long long next = 0;
+
+    // 커서는 getdents64 가 돌려준 d_off: 그 위치로 이동하면 다음 항목부터 이어서 읽힘
+    if (lseek(dir_fd, (off_t)cursor, SEEK_SET) < 0)
+        return -1;
+
+    for (;;)
+    {
+        long nread = syscall(SYS_getdents64, dir_fd, dents, sizeof(dents));
+        if (nread < 0)
+            return -1;
+        if (nread == 0)
+        {
+            next = 0; // 끝까지 읽음
+            break;
+        }
+
+        long off = 0;
+        while (off < nread && (max_entries <= 0 || sent < max_entries))
+        {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(dents + off);
+            off += d->d_reclen;
+
+            // 한 줄이 들어갈 자리가 없으면 먼저 내보냄
+            if (EMIT_BUF_SIZE - used < 512 + strlen(d->d_name))
+            {
+                emit(ctx, out, used);
+                used = 0;
+            }
+            used += listing_format_entry(dir_fd, d->d_name, out + used, EMIT_BUF_SIZE - used);
+            sent++;
+            next = d->d_off;
+        }
+        if (max_entries > 0 && sent >= max_entries)
+            break;
+    }
+
+    if (used > 0)
+        emit(ctx, out, used);
+    if (next_cursor)
+        *next_cursor = next;
+    return 0;
+}
+
+int listing_stream(int dir_fd, ListingEmit emit, void *ctx)
+{
+    return listing_stream_page(dir_fd, 0, 0, emit, ctx, NULL);
+}
@@ -0,0 +1,25 @@
+#ifndef DIR_LISTING_H
+#define DIR_LISTING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LISTING_TOKEN_LEN 64
+
+// listing_stream/listing_stream_page 는 정적 버퍼(getdents 결과, 출력 줄 묶음)를 써서
+// 재진입할 수 없음. 서버의 단일 리액터 스레드에서만 부르고, emit 안에서 다시 부르지 말 것
+
+// 만들어진 줄 묶음을 받는 콜백 (서버에서는 연결 송신 큐로 바로 넘김)
+typedef void (*ListingEmit)(void *ctx, const char *data, size_t len);
+
+int listing_open(int base_fd, const char *path);                 // base_fd 기준 디렉토리 열기, 실패 시 -1
+int listing_stream(int dir_fd, ListingEmit emit, void *ctx);     // ls -al 형식으로 전체 항목 전송, 실패 시 -1
+// cursor 위치부터 최대 max_entries 개 전송 (0 이하면 끝까지). 다음 커서를 돌려주며 0 이면 끝
+int listing_stream_page(int dir_fd, long long cursor, int max_entries,
+                        ListingEmit emit, void *ctx, long long *next_cursor);
+// 목록 검증용 토큰 (장치:inode:mtime). 디렉토리 항목이 바뀌면 mtime 이 바뀌어 토큰도 달라짐
+// path 가 NULL 이면 dir_fd 자신의 토큰
+bool listing_token(int dir_fd, const char *path, char out[LISTING_TOKEN_LEN]);
+size_t listing_format_entry(int dir_fd, const char *name, char *out, size_t size); // 항목 한 줄, 실패 시 0
+
+#endif
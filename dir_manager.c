@@ -1,35 +1,34 @@
 #define _XOPEN_SOURCE 700
 #include "dir_manager.h"
+#include "list_sort.h"
+#include "local_scan.h"
 #include "utils.h"
 #include "socket_client.h"
 #include <dirent.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <strings.h>
 
-// 1. 프로토콜 정의: 서버가 ls 끝에 이 마커를 보내야 함
-#define LS_END_MARKER "ENDLS\n"
+// 1. 프로토콜 정의: 서버는 LSPAGE 응답 끝에 "ENDPAGE <다음 커서>"를 보냄 (0이면 끝)
+#define PAGE_END_MARKER "ENDPAGE"
+#define LIST_PAGE_SIZE 512   // 한 번에 요청하는 항목 수
+#define LIST_PREFETCH 64     // 스캔 직후 최소한 이만큼은 보이도록 페이지를 더 받음
+#define LIST_PREFETCH_PAGES 4 // 단, 스캔 때 받는 페이지는 이만큼까지 (나머지는 스크롤할 때)
 
 /* ============================================================
    벡터 유틸 (동적 배열 관리)
    ============================================================ */
-static void vec_push(char ***arr, int *count, int *cap, const char *s)
+// 문자열은 목록의 풀에 복사 (항목마다 malloc 하지 않음)
+static void vec_push(char ***arr, int *count, int *cap, StrPool *pool, const char *s)
 {
     if (*count + 1 > *cap)
     {
         *cap = (*cap == 0) ? 16 : (*cap * 2);
         *arr = realloc(*arr, sizeof(char *) * (*cap));
     }
-    (*arr)[*count] = strdup(s);
-    (*count)++;
-}
-
-static int cmp_str(const void *a, const void *b)
-{
-    const char *sa = *(const char *const *)a;
-    const char *sb = *(const char *const *)b;
-    return strcasecmp(sa, sb);
+    char *copy = pool_strdup(pool, s);
+    if (copy)
+        (*arr)[(*count)++] = copy;
 }
 
 /* ============================================================
@@ -42,37 +41,195 @@ int socket_is_connected(void)
     return (sockfd >= 0);
 }
 
-// 2. 개선된 수신 함수: 마커가 나올 때까지 데이터를 모두 받음 (잘림 방지)
-static void recv_ls_all(char *recvbuf, size_t bufsize)
+bool remote_pwd(char out[PATH_MAX])
 {
-    recvbuf[0] = '\0';
-    char chunk[4096];
+    char line[PATH_MAX + 8];
+    socket_send_cmd("PWD");
+    if (socket_recv_line(line, sizeof(line)) < 0 || strncmp(line, "OK: ", 4) != 0)
+        return false;
+    strncpy(out, line + 4, PATH_MAX - 1);
+    out[PATH_MAX - 1] = '\0';
+    return true;
+}
 
-    for (;;)
+// ls -al 형식 한 줄에서 종류 문자와 이름(8개 열 뒤의 나머지, 공백 포함)을 꺼냄
+static bool parse_ls_line(const char *line, char *type, const char **name)
+{
+    const char *p = line;
+    for (int field = 0; field < 8; field++)
     {
-        // 소켓에서 조금씩 읽어옴
-        int n = socket_recv_response(chunk, sizeof(chunk));
-        if (n <= 0)
-            break;
+        while (*p && *p != ' ')
+            p++;
+        while (*p == ' ')
+            p++;
+        if (!*p)
+            return false;
+    }
+    *type = line[0];
+    *name = p;
+    return true;
+}
+
+typedef void (*PageItemFn)(void *ctx, char type, const char *name);
+
+// 서버에 목록 검증 토큰만 물어봄 (목록 전체를 받는 것보다 훨씬 작음)
+static bool remote_token(const char *path, char token[DIR_TOKEN_LEN])
+{
+    char cmd[PATH_MAX + 8], line[256];
+    snprintf(cmd, sizeof(cmd), "STAT %s", path);
+    socket_send_cmd(cmd);
+    if (socket_recv_line(line, sizeof(line)) < 0 || strncmp(line, "OK: ", 4) != 0)
+        return false;
+    snprintf(token, DIR_TOKEN_LEN, "%.63s", line + 4);
+    return true;
+}
+
+// 2. 페이지 단위 수신: path 목록을 cursor 부터 한 페이지 받아 항목마다 fn 호출
+//    ENDPAGE 줄까지 모두 읽어 다음 응답과 섞이지 않게 함. 실패하면 false
+//    token 이 NULL 이 아니면 서버가 준 검증 토큰을 채움
+static bool recv_page(const char *path, long long cursor, long long *next, char *token,
+                      PageItemFn fn, void *ctx)
+{
+    char cmd[PATH_MAX + 64];
+    snprintf(cmd, sizeof(cmd), "LSPAGE %lld %d %s", cursor, LIST_PAGE_SIZE, path);
+    socket_send_cmd(cmd);
 
-        // 버퍼 오버플로우 방지
-        if (strlen(recvbuf) + (size_t)n + 1 >= bufsize)
+    bool ok = true;
+    char line[1024];
+    *next = 0;
+    while (socket_recv_line(line, sizeof(line)) >= 0)
+    {
+        if (strncmp(line, PAGE_END_MARKER " ", sizeof(PAGE_END_MARKER)) == 0)
+        {
+            char tok[DIR_TOKEN_LEN] = "";
+            sscanf(line + sizeof(PAGE_END_MARKER), "%lld %63s", next, tok);
+            if (token)
+                snprintf(token, DIR_TOKEN_LEN, "%s", strcmp(tok, "-") == 0 ? "" : tok);
+            return ok;
+        }
+        if (strncmp(line, "ERR", 3) == 0)
         {
-            strncat(recvbuf, chunk, bufsize - strlen(recvbuf) - 1);
-            break;
+            ok = false;
+            continue;
         }
 
-        strncat(recvbuf, chunk, bufsize - strlen(recvbuf) - 1);
+        char type;
+        const char *name;
+        if (!parse_ls_line(line, &type, &name))
+            continue;
+        // . 과 .. 은 제외
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+            continue;
+        fn(ctx, type, name);
+    }
+    return false; // 연결 끊김
+}
+
+/* ============================================================
+   한 번의 LSPAGE 응답으로 디렉토리/파일 두 목록을 함께 채움
+   - 요청한 쪽 목록에는 바로 합치고
+   - 나머지 종류는 캐시에 있는 짝 목록(같은 커서까지 받은 것)에 이어 붙여
+     다른 창이 같은 디렉토리를 열 때 다시 받지 않게 함
+   ============================================================ */
+typedef struct
+{
+    const char *base;  // 디렉토리 항목 절대경로 기준
+    char ***dirs;      // 'd' 항목 (절대경로), NULL 이면 버림
+    int *dcount, *dcap;
+    StrPool *dpool;
+    char ***files;     // '-' 항목 (이름), NULL 이면 버림
+    int *fcount, *fcap;
+    StrPool *fpool;
+} PageSink;
 
-        // 종료 마커("ENDLS")가 포함되어 있으면 수신 중단
-        if (strstr(recvbuf, LS_END_MARKER))
-            break;
+static void page_sink_item(void *ctx, char type, const char *name)
+{
+    PageSink *sink = ctx;
+    if (type == 'd' && sink->dirs)
+    {
+        char p[PATH_MAX];
+        path_join(p, sink->base, name);
+        vec_push(sink->dirs, sink->dcount, sink->dcap, sink->dpool, p);
     }
+    else if (type == '-' && sink->files)
+    {
+        vec_push(sink->files, sink->fcount, sink->fcap, sink->fpool, name);
+    }
+}
+
+static bool fetch_page_both(char kind, const char *path,
+                            char ***items, int *count, int *cap, StrPool *pool, int *selected,
+                            long long *cursor, bool *more, char token[DIR_TOKEN_LEN])
+{
+    char other = (kind == 'd') ? 'f' : 'd';
+    long long start = *cursor;
+
+    // 첫 페이지면 짝 목록도 새로 시작, 아니면 캐시에서 같은 지점까지 받은 짝을 꺼냄
+    CachedList side = {0};
+    side.selected = -1;
+    bool have_side = (start == 0) || dir_cache_take_at(other, path, start, token, &side);
+
+    PageSink sink = {.base = path};
+    if (kind == 'd')
+    {
+        sink.dirs = items, sink.dcount = count, sink.dcap = cap, sink.dpool = pool;
+        if (have_side)
+            sink.files = &side.items, sink.fcount = &side.count, sink.fcap = &side.cap, sink.fpool = &side.pool;
+    }
+    else
+    {
+        sink.files = items, sink.fcount = count, sink.fcap = cap, sink.fpool = pool;
+        if (have_side)
+            sink.dirs = &side.items, sink.dcount = &side.count, sink.dcap = &side.cap, sink.dpool = &side.pool;
+    }
+
+    int old = *count;
+    bool ok = recv_page(path, start, cursor, start == 0 ? token : NULL, page_sink_item, &sink);
+    if (!ok)
+        *cursor = 0;
+    *more = (*cursor != 0);
+    // 다 받기 전에는 서버가 준 순서 그대로 둠. 받은 만큼만 정렬하면 아직 안 온 이름이 빠진 채
+    // 정렬된 것처럼 보이고, 다음 페이지가 선택 위쪽에 끼어들어 선택이 밀림. 마지막 페이지에서 한 번 정렬
+    // 하면서 선택 항목이 옮겨 간 자리를 함께 받음
+    if (!*more)
+        *selected = list_sort(*items, *count, *selected);
+
+    if (have_side)
+    {
+        if (ok && token[0])
+        {
+            if (!*more)
+                side.selected = list_sort(side.items, side.count, side.selected);
+            if (side.selected < 0 && side.count > 0)
+                side.selected = 0;
+            side.cursor = *cursor;
+            side.more = *more;
+            snprintf(side.token, sizeof(side.token), "%s", token);
+        }
+        dir_cache_put(other, path, &side); // 토큰이 없으면 캐시가 버림
+    }
+    return *count > old;
+}
+
+/* ============================================================
+   목록 캐시 연동: 떠나는 목록은 버리지 않고 캐시에 넘기고,
+   다시 들어올 때 서버 토큰이 같으면 그대로 돌려받음
+   ============================================================ */
+static void park_list(char kind, const char *path, char **items, int count, int cap, StrPool *pool,
+                      int selected, long long cursor, bool more, const char *token)
+{
+    CachedList c = {items, count, cap, selected, cursor, more, "", *pool};
+    snprintf(c.token, sizeof(c.token), "%s", token);
+    memset(pool, 0, sizeof(*pool));
+    dir_cache_put(kind, path, &c);
+}
 
-    // 마커 부분은 데이터에서 제거 (화면에 출력되지 않게)
-    char *p = strstr(recvbuf, LS_END_MARKER);
-    if (p)
-        *p = '\0';
+static bool adopt_cached(char kind, const char *path, CachedList *out)
+{
+    char token[DIR_TOKEN_LEN];
+    if (!dir_cache_has(kind, path) || !remote_token(path, token))
+        return false;
+    return dir_cache_take(kind, path, token, out);
 }
 
 /* ============================================================
@@ -86,93 +243,106 @@ void dirlist_init(DirList *dl)
 
 void dirlist_free(DirList *dl)
 {
-    for (int i = 0; i < dl->count; i++)
-        free(dl->items[i]);
+    filter_end(&dl->filter);
     free(dl->items);
+    pool_free(&dl->pool);
     memset(dl, 0, sizeof(*dl));
 }
 
+static void local_dir_item(void *ctx, const char *name)
+{
+    DirList *dl = ctx;
+    char p[PATH_MAX];
+    path_join(p, dl->cwd, name);
+    vec_push(&dl->items, &dl->count, &dl->cap, &dl->pool, p);
+}
+
 void dirlist_scan(DirList *dl, const char *cwd_abs)
 {
-    dirlist_free(dl);
+    filter_end(&dl->filter);
+    // 떠나는 목록은 캐시에 넘기고, 아니면 풀을 한 번에 비워 배열/블록째 다음 목록에 다시 씀
+    char **items = NULL;
+    int cap = 0;
+    StrPool pool = {0};
+    if (socket_is_connected() && dl->token[0])
+    {
+        park_list('d', dl->cwd, dl->items, dl->count, dl->cap, &dl->pool,
+                  dl->selected, dl->cursor, dl->more, dl->token);
+    }
+    else
+    {
+        items = dl->items, cap = dl->cap, pool = dl->pool;
+        pool_reset(&pool);
+    }
     dirlist_init(dl);
+    dl->items = items, dl->cap = cap, dl->pool = pool;
     snprintf(dl->cwd, sizeof(dl->cwd), "%s", cwd_abs);
 
     if (socket_is_connected())
     {
-        // 3. 최적화: 불필요한 'cd' 명령 제거하고 바로 'ls' 요청
-        socket_send_cmd("ls -al");
-
-        // 4. 대용량 버퍼로 전체 데이터 수신
-        char recvbuf[16384];
-        recv_ls_all(recvbuf, sizeof(recvbuf));
-
-        // 파싱
-        char *line = strtok(recvbuf, "\n");
-        while (line)
+        // 바뀌지 않은 디렉토리는 캐시에 있던 목록을 그대로 씀
+        CachedList c;
+        if (adopt_cached('d', dl->cwd, &c))
         {
-            // 'd'로 시작하는 라인 (디렉토리)
-            if (line[0] == 'd')
-            {
-                char perms[11];
-                char name[256];
-
-                // 5. 정교한 파싱: 권한 문자열과 파일명 추출
-                // 예: drwxr-xr-x ... filename
-                if (sscanf(line, "%10s %*s %*s %*s %*s %*s %*s %*s %255s",
-                           perms, name) == 2)
-                {
-                    // . 과 .. 은 제외
-                    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
-                    {
-                        line = strtok(NULL, "\n");
-                        continue;
-                    }
-                    vec_push(&dl->items, &dl->count, &dl->cap, name);
-                }
-            }
-            line = strtok(NULL, "\n");
+            free(dl->items);
+            pool_free(&dl->pool);
+            dl->pool = c.pool;
+            dl->items = c.items;
+            dl->count = c.count;
+            dl->cap = c.cap;
+            dl->selected = c.selected;
+            dl->cursor = c.cursor;
+            dl->more = c.more;
+            snprintf(dl->token, sizeof(dl->token), "%s", c.token);
+            return;
         }
+
+        // 3. 서버 목록은 페이지 단위로 받음: 우선 화면을 채울 만큼만
+        dl->more = true;
+        for (int pages = 0; dl->more && dl->count < LIST_PREFETCH && pages < LIST_PREFETCH_PAGES; pages++)
+            dirlist_fetch_more(dl);
+        dl->selected = (dl->count > 0) ? 0 : -1;
+        return;
     }
     else
     {
-        // 로컬 모드
-        DIR *d = opendir(cwd_abs);
-        if (!d) return;
-        struct dirent *e;
-        while ((e = readdir(d)))
-        {
-            if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
-                continue;
-            
-            char p[PATH_MAX];
-            path_join(p, cwd_abs, e->d_name);
-            if (is_directory(p))
-                vec_push(&dl->items, &dl->count, &dl->cap, p);
-        }
-        closedir(d);
+        // 로컬 모드: 하위 디렉토리만 (d_type, 모르면 fstatat)
+        if (!local_scan_dirs(cwd_abs, local_dir_item, dl))
+            return;
     }
 
-    qsort(dl->items, dl->count, sizeof(char *), cmp_str);
+    list_sort(dl->items, dl->count, -1);
     dl->selected = (dl->count > 0) ? 0 : -1;
 }
 
-void dirlist_draw(WINDOW *win, const DirList *dl, bool focused)
+bool dirlist_fetch_more(DirList *dl)
 {
-    werase(win);
-    box(win, 0, 0);
-    mvwprintw(win, 0, 2, " 현재위치: %s ", dl->cwd);
-    int h, w;
-    getmaxyx(win, h, w);
-    for (int i = 0; i < dl->count && i < h - 2; i++)
-    {
-        const char *name = dl->items[i];
-        int sel = (i == dl->selected);
-        if (sel && focused) wattron(win, A_REVERSE);
-        mvwprintw(win, i + 1, 2, "%c %.*s", sel ? '>' : ' ', w - 4, name);
-        if (sel && focused) wattroff(win, A_REVERSE);
-    }
-    wrefresh(win);
+    if (!dl->more || dl->filter.active || !socket_is_connected())
+        return false;
+
+    bool grew = fetch_page_both('d', dl->cwd, &dl->items, &dl->count, &dl->cap, &dl->pool,
+                                &dl->selected, &dl->cursor, &dl->more, dl->token);
+    if (grew || !dl->more)
+        listview_invalidate(&dl->view);
+    return grew;
+}
+
+// 필터 중에는 맞은 항목만 그리고 제목에 입력한 패턴을 보여 줌
+static void draw_filtered(WINDOW *win, ListView *v, const ListFilter *f, char *const *items, bool focused)
+{
+    const FilterLevel *lv = filter_result(f);
+    char title[FILTER_PATTERN_MAX + 32];
+    snprintf(title, sizeof(title), "/%s (%d개)", f->pattern, lv->count);
+    listview_draw(win, v, "필터", title, items, lv->item, lv->count, f->selected, focused);
+}
+
+void dirlist_draw(WINDOW *win, DirList *dl, bool focused)
+{
+    dl->view.partial = dl->more;
+    if (dl->filter.active)
+        draw_filtered(win, &dl->view, &dl->filter, dl->items, focused);
+    else
+        listview_draw(win, &dl->view, "현재위치", dl->cwd, dl->items, NULL, dl->count, dl->selected, focused);
 }
 
 /* ============================================================
@@ -186,42 +356,56 @@ void filelist_init(FileList *fl)
 
 void filelist_free(FileList *fl)
 {
-    for (int i = 0; i < fl->count; i++)
-        free(fl->items[i]);
+    filter_end(&fl->filter);
     free(fl->items);
+    pool_free(&fl->pool);
     memset(fl, 0, sizeof(*fl));
 }
 
 void filelist_scan(FileList *fl, const char *dir_abs)
 {
-    filelist_free(fl);
+    filter_end(&fl->filter);
+    // 떠나는 목록은 캐시에 넘기고, 아니면 풀을 한 번에 비워 배열/블록째 다음 목록에 다시 씀
+    char **items = NULL;
+    int cap = 0;
+    StrPool pool = {0};
+    if (socket_is_connected() && fl->token[0])
+    {
+        park_list('f', fl->base, fl->items, fl->count, fl->cap, &fl->pool,
+                  fl->selected, fl->cursor, fl->more, fl->token);
+    }
+    else
+    {
+        items = fl->items, cap = fl->cap, pool = fl->pool;
+        pool_reset(&pool);
+    }
     filelist_init(fl);
+    fl->items = items, fl->cap = cap, fl->pool = pool;
     snprintf(fl->base, sizeof(fl->base), "%s", dir_abs);
 
     if (socket_is_connected())
     {
-        // 서버 요청
-        socket_send_cmd("ls -al");
-
-        char recvbuf[16384];
-        recv_ls_all(recvbuf, sizeof(recvbuf));
-
-        char *line = strtok(recvbuf, "\n");
-        while (line)
+        CachedList c;
+        if (adopt_cached('f', fl->base, &c))
         {
-            // '-'로 시작하는 라인 (일반 파일)
-            if (line[0] == '-')
-            {
-                char perms[11];
-                char name[256];
-                if (sscanf(line, "%10s %*s %*s %*s %*s %*s %*s %*s %255s",
-                           perms, name) == 2)
-                {
-                    vec_push(&fl->items, &fl->count, &fl->cap, name);
-                }
-            }
-            line = strtok(NULL, "\n");
+            free(fl->items);
+            pool_free(&fl->pool);
+            fl->pool = c.pool;
+            fl->items = c.items;
+            fl->count = c.count;
+            fl->cap = c.cap;
+            fl->selected = c.selected;
+            fl->cursor = c.cursor;
+            fl->more = c.more;
+            snprintf(fl->token, sizeof(fl->token), "%s", c.token);
+            return;
         }
+
+        fl->more = true;
+        for (int pages = 0; fl->more && fl->count < LIST_PREFETCH && pages < LIST_PREFETCH_PAGES; pages++)
+            filelist_fetch_more(fl);
+        fl->selected = (fl->count > 0) ? 0 : -1;
+        return;
     }
     else
     {
@@ -233,29 +417,32 @@ void filelist_scan(FileList *fl, const char *dir_abs)
         {
             if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
                 continue;
-            vec_push(&fl->items, &fl->count, &fl->cap, e->d_name);
+            vec_push(&fl->items, &fl->count, &fl->cap, &fl->pool, e->d_name);
         }
         closedir(d);
     }
 
-    qsort(fl->items, fl->count, sizeof(char *), cmp_str);
+    list_sort(fl->items, fl->count, -1);
     fl->selected = (fl->count > 0) ? 0 : -1;
 }
 
-void filelist_draw(WINDOW *win, const FileList *fl, bool focused)
+bool filelist_fetch_more(FileList *fl)
 {
-    werase(win);
-    box(win, 0, 0);
-    mvwprintw(win, 0, 2, " 선택한 디렉토리: %s ", fl->base);
-    int h, w;
-    getmaxyx(win, h, w);
-    for (int i = 0; i < fl->count && i < h - 2; i++)
-    {
-        const char *name = fl->items[i];
-        int sel = (i == fl->selected);
-        if (sel && focused) wattron(win, A_REVERSE);
-        mvwprintw(win, i + 1, 2, "%c %.*s", sel ? '>' : ' ', w - 4, name);
-        if (sel && focused) wattroff(win, A_REVERSE);
-    }
-    wrefresh(win);
+    if (!fl->more || fl->filter.active || !socket_is_connected())
+        return false;
+
+    bool grew = fetch_page_both('f', fl->base, &fl->items, &fl->count, &fl->cap, &fl->pool,
+                                &fl->selected, &fl->cursor, &fl->more, fl->token);
+    if (grew || !fl->more)
+        listview_invalidate(&fl->view);
+    return grew;
+}
+
+void filelist_draw(WINDOW *win, FileList *fl, bool focused)
+{
+    fl->view.partial = fl->more;
+    if (fl->filter.active)
+        draw_filtered(win, &fl->view, &fl->filter, fl->items, focused);
+    else
+        listview_draw(win, &fl->view, "선택한 디렉토리", fl->base, fl->items, NULL, fl->count, fl->selected, focused);
 }
\ No newline at end of file
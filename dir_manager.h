@@ -4,30 +4,48 @@
 #include <ncurses.h>
 #include <limits.h>
 #include <stdbool.h>
+#include "dir_cache.h"
+#include "list_filter.h"
+#include "list_view.h"
 
 typedef struct {
     char **items;    // 디렉토리(왼쪽 상단) 목록: 절대경로
     int count, cap;
+    StrPool pool;    // items 의 문자열 (목록 단위로 비움)
     int selected;    // 포커스된 인덱스
     char cwd[PATH_MAX];
+    long long cursor; // 서버 목록의 다음 페이지 위치
+    bool more;        // 아직 받지 않은 페이지가 있음
+    char token[DIR_TOKEN_LEN]; // 목록을 받을 때의 서버 검증 토큰 (캐시용)
+    ListView view;
+    ListFilter filter; // '/' 필터 (active 면 화면과 이동은 필터 결과 기준)
 } DirList;
 
 typedef struct {
     char **items;    // 파일/하위디렉토리(왼쪽 하단) 목록: 이름(상대)
     int count, cap;
+    StrPool pool;
     int selected;
     char base[PATH_MAX]; // 기준 절대경로
+    long long cursor;
+    bool more;
+    char token[DIR_TOKEN_LEN];
+    ListView view;
+    ListFilter filter; // '/' 필터 (active 면 화면과 이동은 필터 결과 기준)
 } FileList;
 
 void dirlist_init(DirList *dl);
 void dirlist_free(DirList *dl);
 void dirlist_scan(DirList *dl, const char *cwd_abs);
-void dirlist_draw(WINDOW *win, const DirList *dl, bool focused);
+bool dirlist_fetch_more(DirList *dl); // 다음 페이지를 받아 붙임. 마지막 페이지면 정렬 (선택 항목 유지)
+void dirlist_draw(WINDOW *win, DirList *dl, bool focused); // 선택이 보이도록 스크롤, wnoutrefresh 까지 (doupdate 는 호출자)
 
 void filelist_init(FileList *fl);
 void filelist_free(FileList *fl);
 void filelist_scan(FileList *fl, const char *dir_abs);
-void filelist_draw(WINDOW *win, const FileList *fl, bool focused);
+bool filelist_fetch_more(FileList *fl);
+void filelist_draw(WINDOW *win, FileList *fl, bool focused);
 int socket_is_connected(void);
+bool remote_pwd(char out[PATH_MAX]); // 서버 세션의 작업 디렉토리 (절대경로)
 
 #endif
@@ -0,0 +1,301 @@
+#define _GNU_SOURCE
+#include "history_store.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define HISTORY_OPEN_MAX 64        // 동시에 열어 두는 방 파일 수
+#define SCAN_BLOCK 8192            // 뒤에서부터 줄을 셀 때 읽는 단위
+#define STREAM_BLOCK (64 * 1024)   // 기록을 흘려보낼 때 읽는 단위
+#define RECORD_MAX 4096            // 한 기록의 최대 길이 (명령 길이 제한보다 넉넉히)
+#define FILE_NAME_KEEP 180         // 이보다 긴 파일 이름은 잘라내고 해시를 붙임
+
+/* ============================================================
+   서버 채팅 기록 저장소
+   - 방마다 추가 전용 파일 하나 ("<ts> <user> <text>\n")
+   - ts 는 파일 안에서 줄지 않도록 맞춰 두어 시간 구간은 이진 탐색으로 찾음
+   - 최근 N 개는 파일 끝에서부터 개행을 세어 시작 위치를 찾음
+   - 자주 쓰는 방 파일은 열어 두고 오래 안 쓴 것부터 닫음
+   ============================================================ */
+typedef struct
+{
+    char room[HISTORY_ROOM_MAX]; // 비어 있으면 빈 칸
+    int fd;
+    long long last_ts;           // 마지막 기록 시각
+    unsigned long last_use;
+} HistoryFile;
+
+static int hist_dir_fd = -1;
+static HistoryFile files[HISTORY_OPEN_MAX];
+static unsigned long use_clock = 0;
+
+bool history_init(const char *dir)
+{
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+        return false;
+    hist_dir_fd = open(dir, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    return hist_dir_fd >= 0;
+}
+
+bool history_valid_room(const char *room)
+{
+    size_t len = room ? strlen(room) : 0;
+    if (len == 0 || len >= HISTORY_ROOM_MAX)
+        return false;
+    for (size_t i = 0; i < len; i++)
+        if (isspace((unsigned char)room[i]) || iscntrl((unsigned char)room[i]))
+            return false;
+    return true;
+}
+
+// 방 이름 → 파일 이름. 영숫자와 . - _ 외에는 %XX 로 바꿔 '/' 등이 경로가 되지 않게 함
+static void room_file_name(const char *room, char out[NAME_MAX + 1])
+{
+    static const char hex[] = "0123456789ABCDEF";
+    size_t o = 0;
+    uint64_t hash = 1469598103934665603ULL; // FNV-1a
+    for (const unsigned char *p = (const unsigned char *)room; *p; p++)
+    {
+        hash = (hash ^ *p) * 1099511628211ULL;
+        if (o + 3 >= FILE_NAME_KEEP)
+            continue;
+        if (isalnum(*p) || *p == '.' || *p == '-' || *p == '_')
+            out[o++] = (char)*p;
+        else
+        {
+            out[o++] = '%';
+            out[o++] = hex[*p >> 4];
+            out[o++] = hex[*p & 15];
+        }
+    }
+    if (o + 3 >= FILE_NAME_KEEP)
+        o += (size_t)snprintf(out + o, NAME_MAX + 1 - o, "~%016llx", (unsigned long long)hash);
+    snprintf(out + o, NAME_MAX + 1 - o, ".log");
+}
+
+static long long read_ts(int fd, off_t off)
+{
+    char buf[32];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, off);
+    if (n <= 0)
+        return LLONG_MAX;
+    buf[n] = '\0';
+    return strtoll(buf, NULL, 10);
+}
+
+// off 이상에서 시작하는 첫 줄의 위치 (없으면 limit)
+static off_t next_line_start(int fd, off_t off, off_t limit)
+{
+    if (off == 0)
+        return 0;
+    char buf[SCAN_BLOCK];
+    for (off_t pos = off - 1; pos < limit;)
+    {
+        size_t want = (size_t)(limit - pos < SCAN_BLOCK ? limit - pos : SCAN_BLOCK);
+        ssize_t n = pread(fd, buf, want, pos);
+        if (n <= 0)
+            break;
+        char *nl = memchr(buf, '\n', (size_t)n);
+        if (nl)
+            return pos + (nl - buf) + 1;
+        pos += n;
+    }
+    return limit;
+}
+
+// ts >= from 인 첫 기록의 위치 (없으면 size)
+static off_t find_ts(int fd, off_t size, long long from)
+{
+    off_t lo = 0, hi = size; // lo: 항상 줄 시작, 그 앞의 기록은 모두 from 보다 이전
+    while (lo < hi)
+    {
+        off_t s = next_line_start(fd, lo + (hi - lo) / 2, hi);
+        if (s >= hi)
+            s = lo; // 가운데 이후로 줄이 없으면 lo 의 줄을 직접 확인
+        if (read_ts(fd, s) >= from)
+            hi = s;
+        else
+            lo = next_line_start(fd, s + 1, hi);
+    }
+    return lo;
+}
+
+// 끝에서 n 번째 기록의 위치
+static off_t find_last(int fd, off_t size, int n)
+{
+    if (n <= 0)
+        return size;
+    char buf[SCAN_BLOCK];
+    int seen = 0;
+    off_t pos = size - 1; // 마지막 개행은 건너뜀
+    while (pos > 0)
+    {
+        size_t chunk = (size_t)(pos > SCAN_BLOCK ? SCAN_BLOCK : pos);
+        off_t base = pos - (off_t)chunk;
+        if (pread(fd, buf, chunk, base) != (ssize_t)chunk)
+            return 0;
+        for (ssize_t i = (ssize_t)chunk - 1; i >= 0; i--)
+            if (buf[i] == '\n' && ++seen == n)
+                return base + i + 1;
+        pos = base;
+    }
+    return 0;
+}
+
+// [start, end) 의 기록을 ts 가 to 를 넘기 전까지 최대 max 개 전송
+static int stream_records(int fd, off_t start, off_t end, long long to, int max,
+                          HistoryEmit emit, void *ctx)
+{
+    static char buf[STREAM_BLOCK]; // 서버는 단일 스레드
+    size_t have = 0;
+    int sent = 0;
+    while (start < end)
+    {
+        size_t want = sizeof(buf) - have;
+        if ((off_t)want > end - start)
+            want = (size_t)(end - start);
+        ssize_t n = pread(fd, buf + have, want, start);
+        if (n <= 0)
+            break;
+        start += n;
+        have += (size_t)n;
+
+        size_t pos = 0;
+        char *nl;
+        while ((nl = memchr(buf + pos, '\n', have - pos)))
+        {
+            size_t len = (size_t)(nl - (buf + pos));
+            *nl = '\0';
+            if (strtoll(buf + pos, NULL, 10) > to)
+                return sent;
+            emit(ctx, buf + pos, len);
+            if (++sent >= max && max > 0)
+                return sent;
+            pos += len + 1;
+        }
+        if (pos == 0 && have == sizeof(buf))
+            have = 0; // 개행 없이 버퍼를 채운 손상된 줄은 버림
+        else
+        {
+            memmove(buf, buf + pos, have - pos);
+            have -= pos;
+        }
+    }
+    return sent;
+}
+
+static HistoryFile *open_room(const char *room, bool create)
+{
+    if (hist_dir_fd < 0 || !history_valid_room(room))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    HistoryFile *victim = &files[0];
+    for (int i = 0; i < HISTORY_OPEN_MAX; i++)
+    {
+        HistoryFile *f = &files[i];
+        if (f->room[0] && strcmp(f->room, room) == 0)
+        {
+            f->last_use = ++use_clock;
+            return f;
+        }
+        if (!f->room[0])
+            victim = f;
+        else if (victim->room[0] && f->last_use < victim->last_use)
+            victim = f;
+    }
+
+    char name[NAME_MAX + 1];
+    room_file_name(room, name);
+    int flags = O_RDWR | O_APPEND | O_CLOEXEC | (create ? O_CREAT : 0);
+    int fd = openat(hist_dir_fd, name, flags, 0644);
+    if (fd < 0)
+        return NULL;
+
+    if (victim->room[0])
+        close(victim->fd);
+    snprintf(victim->room, sizeof(victim->room), "%s", room);
+    victim->fd = fd;
+    victim->last_use = ++use_clock;
+    victim->last_ts = 0;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        victim->last_ts = read_ts(fd, find_last(fd, st.st_size, 1));
+    if (victim->last_ts == LLONG_MAX)
+        victim->last_ts = 0;
+    return victim;
+}
+
+static off_t room_size(HistoryFile *f)
+{
+    struct stat st;
+    return fstat(f->fd, &st) == 0 ? st.st_size : 0;
+}
+
+long long history_append(const char *room, long long ts, const char *user, const char *text)
+{
+    HistoryFile *f = open_room(room, true);
+    if (!f)
+        return -1;
+    if (ts < f->last_ts)
+        ts = f->last_ts; // 시계가 뒤로 가도 파일 안의 순서는 유지
+
+    char rec[RECORD_MAX];
+    int len = snprintf(rec, sizeof(rec), "%lld %s %s\n", ts, user, text);
+    if (len < 0)
+        return -1;
+    if ((size_t)len >= sizeof(rec))
+    {
+        len = sizeof(rec) - 1;
+        rec[len - 1] = '\n';
+    }
+    // O_APPEND 에 한 번의 write 라 기록이 섞이지 않음
+    if (write(f->fd, rec, (size_t)len) != len)
+        return -1;
+    f->last_ts = ts;
+    return ts;
+}
+
+int history_last(const char *room, int n, HistoryEmit emit, void *ctx)
+{
+    HistoryFile *f = open_room(room, false);
+    if (!f)
+        return errno == ENOENT ? 0 : -1;
+    off_t size = room_size(f);
+    return stream_records(f->fd, find_last(f->fd, size, n), size, LLONG_MAX, n, emit, ctx);
+}
+
+int history_range(const char *room, long long from, long long to, int max, HistoryEmit emit, void *ctx)
+{
+    HistoryFile *f = open_room(room, false);
+    if (!f)
+        return errno == ENOENT ? 0 : -1;
+    off_t size = room_size(f);
+    return stream_records(f->fd, find_ts(f->fd, size, from), size, to, max, emit, ctx);
+}
+
+int history_since(const char *room, long long since, int seen, int max, HistoryEmit emit, void *ctx)
+{
+    HistoryFile *f = open_room(room, false);
+    if (!f)
+        return errno == ENOENT ? 0 : -1;
+    off_t size = room_size(f);
+    off_t start = find_ts(f->fd, size, seen < 0 ? since + 1 : since);
+    // 같은 초에 남은 기록 중 클라이언트가 이미 받은 앞쪽 seen 개는 건너뜀
+    for (int i = 0; i < seen && start < size && read_ts(f->fd, start) == since; i++)
+        start = next_line_start(f->fd, start + 1, size);
+    off_t last = find_last(f->fd, size, max);
+    if (last > start)
+        start = last;
+    return stream_records(f->fd, start, size, LLONG_MAX, max, emit, ctx);
+}
@@ -0,0 +1,23 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define HISTORY_ROOM_MAX 256 // 방 이름 최대 길이 (NUL 포함)
+
+// 기록 한 줄("<ts> <user> <text>", 개행 제외)을 받는 콜백
+typedef void (*HistoryEmit)(void *ctx, const char *record, size_t len);
+
+bool history_init(const char *dir); // 기록 디렉토리 준비 (없으면 생성)
+bool history_valid_room(const char *room);
+// 방 기록 끝에 추가. 시각이 뒤로 가지 않도록 맞춘 실제 기록 시각을 돌려줌 (실패 시 -1)
+long long history_append(const char *room, long long ts, const char *user, const char *text);
+int history_last(const char *room, int n, HistoryEmit emit, void *ctx); // 최근 n 개, 보낸 개수 (실패 시 -1)
+// from <= ts <= to 인 기록을 오래된 것부터 최대 max 개
+int history_range(const char *room, long long from, long long to, int max, HistoryEmit emit, void *ctx);
+// ts >= since 인 기록 중 최근 max 개 (재접속 시 빠진 부분만 다시 보냄).
+// ts == since 인 기록은 앞의 seen 개를 건너뜀 (seen < 0 이면 모두 건너뜀, 곧 ts > since)
+int history_since(const char *room, long long since, int seen, int max, HistoryEmit emit, void *ctx);
+
+#endif
@@ -1,21 +1,63 @@
 #define _XOPEN_SOURCE 700
 #include "input_manager.h"
+#include <ctype.h>
 #include <string.h>
 
-void input_draw(WINDOW *win) {
+/* ============================================================
+   입력 줄 편집
+   - 예전에는 wgetnstr 로 Enter 까지 붙잡고 있어서 입력 중에는 채팅 푸시가 그려지지 않았음
+   - 이제 키를 하나씩 받아 버퍼에 반영하고 바로 돌아감 (대기는 메인 루프의 poll 하나)
+   - 줄은 UTF-8 바이트 그대로 모으고, 지울 때는 글자 하나(이어지는 바이트 포함)를 지움
+   ============================================================ */
+void input_setup(WINDOW *win) {
+    keypad(win, TRUE);
+    nodelay(win, TRUE);
+}
+
+void input_draw(WINDOW *win, const InputLine *in) {
+    int w = getmaxx(win);
     werase(win); box(win,0,0);
     mvwprintw(win,0,2," 입력 ");
     mvwprintw(win,1,2,"> ");
-    wmove(win,1,4);
-    wrefresh(win);
+    // 창보다 길면 끝부분만 (바이트 수로 어림잡고 글자 중간에서 자르지 않음)
+    int room = w - 6, start = 0;
+    if (room > 0 && in->len > room) {
+        start = in->len - room;
+        while (start < in->len && ((unsigned char)in->buf[start] & 0xC0) == 0x80) start++;
+    }
+    if (in->len > start) waddnstr(win, in->buf + start, in->len - start);
+    wnoutrefresh(win);
+}
+
+// 마지막 글자가 아직 다 들어오지 않은 UTF-8 이면 true (그 사이에는 다시 그리지 않음)
+static bool tail_incomplete(const InputLine *in) {
+    int i = in->len;
+    while (i > 0 && ((unsigned char)in->buf[i-1] & 0xC0) == 0x80) i--;
+    if (i == 0) return false;
+    unsigned char lead = (unsigned char)in->buf[i-1];
+    int need = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+    return in->len - (i-1) < need;
+}
+
+void input_clear(InputLine *in) {
+    in->len = 0;
+    in->buf[0] = '\0';
 }
 
-int input_capture_line(WINDOW *win, char *out, int maxlen) {
-    // 호출 전: 커서 위치는 1,4
-    echo();
-    wgetnstr(win, out, maxlen-1);
-    noecho();
-    return (int)strlen(out);
+InputEvent input_key(WINDOW *win, InputLine *in, int ch) {
+    if (ch == '\n' || ch == KEY_ENTER) return INPUT_SUBMIT;
+    if (ch == 27) return INPUT_LEAVE;
+    if (ch == KEY_BACKSPACE || ch == 127 || ch == 8) {
+        while (in->len > 0 && ((unsigned char)in->buf[--in->len] & 0xC0) == 0x80) {}
+        in->buf[in->len] = '\0';
+    } else if (ch >= 0 && ch < 256 && (ch >= 0x80 || isprint(ch)) && in->len < INPUT_LINE_MAX - 1) {
+        in->buf[in->len++] = (char)ch; // 한글 등은 바이트 단위로 들어옴
+        in->buf[in->len] = '\0';
+    } else {
+        return INPUT_EDITING;
+    }
+    if (!tail_incomplete(in)) input_draw(win, in);
+    return INPUT_EDITING;
 }
 
 void status_bar(WINDOW *chat_win, const char *msg) {
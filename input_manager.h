@@ -11,8 +11,24 @@ typedef enum {
     FOCUS_INPUT = 3
 } FocusArea;
 
-void input_draw(WINDOW *win);
-int  input_capture_line(WINDOW *win, char *out, int maxlen); // Enter로 종료
+#define INPUT_LINE_MAX 4096
+
+// 입력창에서 편집 중인 한 줄. 키는 메인 루프가 하나씩 넘겨 주므로 입력 중에도 다른 이벤트를 처리함
+typedef struct {
+    char buf[INPUT_LINE_MAX];
+    int len;
+} InputLine;
+
+typedef enum {
+    INPUT_EDITING = 0, // 계속 입력 중
+    INPUT_SUBMIT,      // Enter: buf 에 완성된 줄 (처리 후 input_clear)
+    INPUT_LEAVE,       // Esc: 입력창을 떠남 (쓰던 내용은 남겨 둠)
+} InputEvent;
+
+void input_setup(WINDOW *win);                           // keypad + nodelay (wgetch 가 기다리지 않음)
+void input_draw(WINDOW *win, const InputLine *in);       // 쓰던 내용까지 다시 그림 (wnoutrefresh)
+InputEvent input_key(WINDOW *win, InputLine *in, int ch); // 키 하나 반영
+void input_clear(InputLine *in);
 void status_bar(WINDOW *chat_win, const char *msg);
 const char* focus_name(FocusArea f);
 
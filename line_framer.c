@@ -0,0 +1,87 @@
+#include "line_framer.h"
+#include <stdlib.h>
+#include <string.h>
+
+void framer_init(LineFramer *f, size_t max_line)
+{
+    memset(f, 0, sizeof(*f));
+    f->max_line = max_line;
+    f->buf = malloc(max_line + 1);
+}
+
+void framer_free(LineFramer *f)
+{
+    free(f->buf);
+    memset(f, 0, sizeof(*f));
+}
+
+char *framer_space(LineFramer *f, size_t *avail)
+{
+    if (!f->buf)
+    {
+        *avail = 0;
+        return NULL;
+    }
+    // 이미 꺼낸 줄이 차지하던 앞부분을 비워 공간 확보
+    if (f->pos > 0)
+    {
+        memmove(f->buf, f->buf + f->pos, f->len - f->pos);
+        f->len -= f->pos;
+        f->pos = 0;
+    }
+    *avail = f->max_line - f->len;
+    return f->buf + f->len;
+}
+
+void framer_commit(LineFramer *f, size_t n)
+{
+    f->len += n;
+}
+
+bool framer_take_dropped(LineFramer *f)
+{
+    bool dropped = f->dropped;
+    f->dropped = false;
+    return dropped;
+}
+
+bool framer_has_line(const LineFramer *f)
+{
+    return f->buf && memchr(f->buf + f->pos, '\n', f->len - f->pos) != NULL;
+}
+
+char *framer_next(LineFramer *f)
+{
+    while (f->buf && f->pos < f->len)
+    {
+        char *start = f->buf + f->pos;
+        size_t avail = f->len - f->pos;
+        char *nl = memchr(start, '\n', avail);
+
+        if (!nl)
+        {
+            // 줄이 버퍼보다 길면 잘린 앞부분도 내보내지 않고 개행이 올 때까지 통째로 버린다
+            if (f->pos == 0 && f->len == f->max_line)
+            {
+                if (!f->skipping)
+                    f->dropped = true;
+                f->skipping = true;
+                f->pos = f->len;
+            }
+            return NULL;
+        }
+
+        *nl = '\0';
+        f->pos = (size_t)(nl - f->buf) + 1;
+        if (f->skipping)
+        {
+            // 너무 긴 줄의 꼬리까지 버림
+            f->skipping = false;
+            continue;
+        }
+        if (nl > start && nl[-1] == '\r')
+            nl[-1] = '\0';
+        return start;
+    }
+    return NULL;
+}
@@ -0,0 +1,26 @@
+#ifndef LINE_FRAMER_H
+#define LINE_FRAMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// 개행('\n') 단위 프레이밍: recv로 받은 바이트를 쌓아두고 완성된 줄만 꺼낸다.
+typedef struct {
+    char *buf;
+    size_t len;      // 버퍼에 들어 있는 바이트
+    size_t pos;      // 아직 꺼내지 않은 데이터의 시작
+    size_t max_line; // 한 줄 최대 길이 (넘는 줄은 내보내지 않고 통째로 버림)
+    bool skipping;   // 너무 긴 줄의 나머지를 버리는 중
+    bool dropped;    // 너무 긴 줄을 버렸고 아직 framer_take_dropped 로 확인하지 않음
+} LineFramer;
+
+void framer_init(LineFramer *f, size_t max_line);
+void framer_free(LineFramer *f);
+char *framer_space(LineFramer *f, size_t *avail); // recv로 채울 빈 공간
+void framer_commit(LineFramer *f, size_t n);      // 방금 채운 바이트 수 반영
+char *framer_next(LineFramer *f);                 // 완성된 한 줄 (개행/CR 제거, NUL 종료) 없으면 NULL
+                                                  // 반환된 포인터는 다음 framer_space 호출 전까지 유효
+bool framer_take_dropped(LineFramer *f);         // 마지막 확인 이후 너무 긴 줄을 버렸으면 true (한 번만)
+bool framer_has_line(const LineFramer *f);
+
+#endif
@@ -0,0 +1,160 @@
+#include "list_filter.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+   목록 필터 (부분 순서 일치: 패턴 글자가 이름에 순서대로 들어 있으면 맞음)
+   - 필터를 시작할 때 이름마다 소문자 키를 한 번만 만들어 한 버퍼에 모음
+   - 글자를 더하면 직전 결과만 훑고, 각 항목은 직전 글자가 맞은 위치부터
+     다음 글자를 찾음 (전체 목록을 처음부터 다시 보지 않음)
+   - 글자를 지우면 보관해 둔 이전 단계 결과로 돌아감 (다시 계산하지 않음)
+   ============================================================ */
+static char lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static bool level_reserve(FilterLevel *lv, int n)
+{
+    if (n <= lv->cap)
+        return true;
+    int *item = realloc(lv->item, sizeof(int) * (size_t)n);
+    if (!item)
+        return false;
+    lv->item = item;
+    int *end = realloc(lv->end, sizeof(int) * (size_t)n);
+    if (!end)
+        return false;
+    lv->end = end;
+    lv->cap = n;
+    return true;
+}
+
+// 결과(오름차순)에서 항목 번호 위치를 찾음. 없으면 -1
+static int level_find(const FilterLevel *lv, int item)
+{
+    int lo = 0, hi = lv->count - 1;
+    while (lo <= hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (lv->item[mid] == item)
+            return mid;
+        if (lv->item[mid] < item)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return -1;
+}
+
+// 결과가 바뀌어도 선택했던 항목이 남아 있으면 그대로 가리킴
+static void keep_selection(ListFilter *f, int item)
+{
+    int pos = item >= 0 ? level_find(filter_result(f), item) : -1;
+    f->selected = pos >= 0 ? pos : 0;
+}
+
+bool filter_begin(ListFilter *f, char *const *items, int count, int selected, bool basename)
+{
+    memset(f, 0, sizeof(*f));
+    size_t total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const char *name = items[i];
+        const char *slash = basename ? strrchr(name, '/') : NULL;
+        total += strlen(slash && slash[1] ? slash + 1 : name) + 1;
+    }
+
+    f->keybuf = malloc(total ? total : 1);
+    f->keys = malloc(sizeof(char *) * (size_t)(count ? count : 1));
+    if (!f->keybuf || !f->keys || !level_reserve(&f->levels[0], count ? count : 1))
+    {
+        filter_end(f);
+        return false;
+    }
+
+    char *p = f->keybuf;
+    for (int i = 0; i < count; i++)
+    {
+        const char *name = items[i];
+        const char *slash = basename ? strrchr(name, '/') : NULL;
+        if (slash && slash[1])
+            name = slash + 1;
+        f->keys[i] = p;
+        while (*name)
+            *p++ = lower(*name++);
+        *p++ = '\0';
+        f->levels[0].item[i] = i;
+        f->levels[0].end[i] = 0;
+    }
+    f->key_count = count;
+    f->levels[0].count = count;
+    f->origin = selected;
+    f->selected = (selected >= 0 && selected < count) ? selected : 0;
+    f->active = true;
+    return true;
+}
+
+void filter_end(ListFilter *f)
+{
+    for (int k = 0; k < FILTER_PATTERN_MAX; k++)
+    {
+        free(f->levels[k].item);
+        free(f->levels[k].end);
+    }
+    free(f->keys);
+    free(f->keybuf);
+    memset(f, 0, sizeof(*f));
+}
+
+bool filter_push(ListFilter *f, char c)
+{
+    if (!f->active || f->len + 1 >= FILTER_PATTERN_MAX || c == '\0')
+        return false;
+    const FilterLevel *prev = &f->levels[f->len];
+    FilterLevel *next = &f->levels[f->len + 1];
+    if (!level_reserve(next, prev->count ? prev->count : 1))
+        return false;
+
+    int was = filter_item(f);
+    char lc = lower(c);
+    int n = 0;
+    for (int i = 0; i < prev->count; i++)
+    {
+        const char *key = f->keys[prev->item[i]];
+        const char *hit = strchr(key + prev->end[i], lc);
+        if (hit)
+        {
+            next->item[n] = prev->item[i];
+            next->end[n] = (int)(hit - key) + 1;
+            n++;
+        }
+    }
+    next->count = n;
+    f->pattern[f->len++] = c;
+    f->pattern[f->len] = '\0';
+    keep_selection(f, was);
+    return true;
+}
+
+void filter_pop(ListFilter *f)
+{
+    if (!f->active || f->len == 0)
+        return;
+    int was = filter_item(f);
+    f->pattern[--f->len] = '\0';
+    keep_selection(f, was);
+}
+
+const FilterLevel *filter_result(const ListFilter *f)
+{
+    return &f->levels[f->len];
+}
+
+int filter_item(const ListFilter *f)
+{
+    const FilterLevel *lv = filter_result(f);
+    if (!f->active || f->selected < 0 || f->selected >= lv->count)
+        return -1;
+    return lv->item[f->selected];
+}
@@ -0,0 +1,35 @@
+#ifndef LIST_FILTER_H
+#define LIST_FILTER_H
+
+#include <stdbool.h>
+
+#define FILTER_PATTERN_MAX 64 // 필터 입력 최대 길이 (NUL 포함)
+
+// 패턴 앞 k 글자에 맞는 항목들
+typedef struct {
+    int *item;   // 맞은 항목 번호 (오름차순)
+    int *end;    // 그 항목 키에서 마지막으로 맞은 글자 다음 위치 (다음 글자는 여기부터 찾음)
+    int count, cap;
+} FilterLevel;
+
+typedef struct {
+    char *keybuf;        // 소문자 키를 이어 붙인 버퍼 (항목마다 NUL 로 끝남)
+    char **keys;         // 항목별 키 (keybuf 안을 가리킴)
+    int key_count;
+    char pattern[FILTER_PATTERN_MAX];
+    int len;
+    FilterLevel levels[FILTER_PATTERN_MAX]; // levels[k]: 패턴 앞 k 글자의 결과 (0 은 전체)
+    int selected;        // 현재 결과 안에서의 선택 위치
+    int origin;          // 필터를 시작할 때의 목록 선택 위치 (취소하면 되돌림)
+    bool active;
+} ListFilter;
+
+// items 의 소문자 키를 만들고 필터 시작. basename 이면 마지막 '/' 뒤만 비교
+bool filter_begin(ListFilter *f, char *const *items, int count, int selected, bool basename);
+void filter_end(ListFilter *f);            // 메모리 해제, active = false
+bool filter_push(ListFilter *f, char c);   // 한 글자 추가: 직전 결과만 다시 봄
+void filter_pop(ListFilter *f);            // 한 글자 삭제: 이전 결과를 그대로 씀
+const FilterLevel *filter_result(const ListFilter *f);
+int filter_item(const ListFilter *f);      // 선택된 결과의 항목 번호 (결과가 없으면 -1)
+
+#endif
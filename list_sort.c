@@ -0,0 +1,253 @@
+#include "list_sort.h"
+#include "str_pool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SORT_NAME_MAX 1024 // 접은 이름 버퍼 (파일 이름은 255바이트 이하)
+
+/* ============================================================
+   목록 정렬
+   - 항목마다 정렬 키(strxfrm)를 한 번만 만들고, 키 앞 8바이트를 정수로
+     묶어 두어 대부분의 비교를 정수 비교로 끝냄 (비교마다 strcoll 하지 않음)
+   - 큰 목록은 조각으로 나눠 스레드마다 키 만들기 + 정렬, 이후 두 조각씩 병렬로 합침
+   ============================================================ */
+typedef struct
+{
+    uint64_t prefix; // 키 앞 8바이트 (big-endian)
+    const char *key; // 전체 정렬 키
+    char *name;
+} SortEntry;
+
+static const char *sort_part(const char *name)
+{
+    const char *slash = strrchr(name, '/');
+    return (slash && slash[1]) ? slash + 1 : name;
+}
+
+static void fold(char *dst, const char *src)
+{
+    size_t i = 0;
+    for (; src[i] && i < SORT_NAME_MAX - 1; i++)
+        dst[i] = (src[i] >= 'A' && src[i] <= 'Z') ? (char)(src[i] + ('a' - 'A')) : src[i];
+    dst[i] = '\0';
+}
+
+int list_collate(const char *a, const char *b)
+{
+    char fa[SORT_NAME_MAX], fb[SORT_NAME_MAX];
+    fold(fa, sort_part(a));
+    fold(fb, sort_part(b));
+    int c = strcoll(fa, fb);
+    return c ? c : strcmp(a, b);
+}
+
+static bool make_entry(SortEntry *e, char *name, StrPool *pool)
+{
+    char folded[SORT_NAME_MAX], buf[512];
+    fold(folded, sort_part(name));
+    size_t n = strxfrm(buf, folded, sizeof(buf));
+    const char *key;
+    if (n < sizeof(buf))
+    {
+        key = pool_strndup(pool, buf, n);
+    }
+    else
+    {
+        char *big = malloc(n + 1);
+        if (!big)
+            return false;
+        strxfrm(big, folded, n + 1);
+        key = pool_strndup(pool, big, n);
+        free(big);
+    }
+    if (!key)
+        return false;
+
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; i++)
+        prefix = (prefix << 8) | (i < n ? (unsigned char)key[i] : 0);
+    e->prefix = prefix;
+    e->key = key;
+    e->name = name;
+    return true;
+}
+
+static int cmp_entry(const void *pa, const void *pb)
+{
+    const SortEntry *a = pa, *b = pb;
+    if (a->prefix != b->prefix)
+        return a->prefix < b->prefix ? -1 : 1;
+    int c = strcmp(a->key, b->key);
+    return c ? c : strcmp(a->name, b->name);
+}
+
+static int cmp_collate(const void *a, const void *b)
+{
+    return list_collate(*(char *const *)a, *(char *const *)b);
+}
+
+/* ------------------------------------------------------------
+   조각 정렬 (스레드 하나가 맡는 구간)
+   ------------------------------------------------------------ */
+typedef struct
+{
+    SortEntry *entries;
+    char **names;
+    int count;
+    StrPool pool; // 이 조각의 키
+    bool ok;
+} SortChunk;
+
+static void *sort_chunk(void *arg)
+{
+    SortChunk *c = arg;
+    c->ok = true;
+    for (int i = 0; i < c->count && c->ok; i++)
+        c->ok = make_entry(&c->entries[i], c->names[i], &c->pool);
+    if (c->ok)
+        qsort(c->entries, c->count, sizeof(SortEntry), cmp_entry);
+    return NULL;
+}
+
+typedef struct
+{
+    const SortEntry *a, *b;
+    int na, nb;
+    SortEntry *out;
+} MergeJob;
+
+static void *merge_run(void *arg)
+{
+    MergeJob *m = arg;
+    int i = 0, j = 0, k = 0;
+    while (i < m->na && j < m->nb)
+        m->out[k++] = (cmp_entry(&m->b[j], &m->a[i]) < 0) ? m->b[j++] : m->a[i++];
+    memcpy(m->out + k, m->a + i, sizeof(SortEntry) * (m->na - i));
+    k += m->na - i;
+    memcpy(m->out + k, m->b + j, sizeof(SortEntry) * (m->nb - j));
+    return NULL;
+}
+
+static int sort_threads(int count)
+{
+    if (count < LIST_SORT_PARALLEL_MIN)
+        return 1;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int t = cpus > 1 ? (int)cpus : 1;
+    if (t > LIST_SORT_THREADS_MAX)
+        t = LIST_SORT_THREADS_MAX;
+    if (t > count / (LIST_SORT_PARALLEL_MIN / 2))
+        t = count / (LIST_SORT_PARALLEL_MIN / 2);
+    return t > 1 ? t : 1;
+}
+
+// jobs 를 스레드로 돌림 (첫 작업은 호출한 스레드가 직접). 스레드를 못 만들면 그 자리에서 실행
+static void run_jobs(void *(*fn)(void *), void *jobs, size_t size, int n)
+{
+    pthread_t tid[LIST_SORT_THREADS_MAX];
+    bool started[LIST_SORT_THREADS_MAX] = {false};
+    for (int i = 1; i < n; i++)
+        started[i] = pthread_create(&tid[i], NULL, fn, (char *)jobs + size * i) == 0;
+    fn(jobs);
+    for (int i = 1; i < n; i++)
+    {
+        if (started[i])
+            pthread_join(tid[i], NULL);
+        else
+            fn((char *)jobs + size * i);
+    }
+}
+
+// 정렬된 names 에서 tracked 의 위치 (키를 못 만들어 qsort 로 정렬했을 때만 씀)
+static int locate(char **names, int count, const char *tracked)
+{
+    int lo = 0, hi = count;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (list_collate(names[mid], tracked) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int list_sort(char **names, int count, int track)
+{
+    if (count < 2 || track >= count)
+        return track;
+    const char *tracked = track >= 0 ? names[track] : NULL;
+    SortEntry *entries = malloc(sizeof(SortEntry) * (size_t)count);
+    SortEntry *tmp = NULL;
+    int t = sort_threads(count);
+    if (entries && t > 1 && !(tmp = malloc(sizeof(SortEntry) * (size_t)count)))
+        t = 1;
+    if (!entries)
+    {
+        qsort(names, count, sizeof(char *), cmp_collate);
+        return tracked ? locate(names, count, tracked) : track;
+    }
+
+    SortChunk chunks[LIST_SORT_THREADS_MAX];
+    int bounds[LIST_SORT_THREADS_MAX + 1];
+    memset(chunks, 0, sizeof(chunks));
+    for (int i = 0; i <= t; i++)
+        bounds[i] = (int)((long long)count * i / t);
+    for (int i = 0; i < t; i++)
+    {
+        chunks[i].entries = entries + bounds[i];
+        chunks[i].names = names + bounds[i];
+        chunks[i].count = bounds[i + 1] - bounds[i];
+    }
+    run_jobs(sort_chunk, chunks, sizeof(SortChunk), t);
+
+    bool ok = true;
+    for (int i = 0; i < t; i++)
+        ok = ok && chunks[i].ok;
+
+    // 정렬된 조각들을 두 개씩 합치기를 한 조각이 남을 때까지 반복
+    SortEntry *src = entries, *dst = tmp;
+    for (int width = 1; ok && width < t; width *= 2)
+    {
+        MergeJob jobs[LIST_SORT_THREADS_MAX];
+        int n = 0;
+        for (int i = 0; i < t; i += 2 * width)
+        {
+            int lo = bounds[i];
+            int mid = bounds[i + width < t ? i + width : t];
+            int hi = bounds[i + 2 * width < t ? i + 2 * width : t];
+            jobs[n++] = (MergeJob){src + lo, src + mid, mid - lo, hi - mid, dst + lo};
+        }
+        run_jobs(merge_run, jobs, sizeof(MergeJob), n);
+        SortEntry *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (ok)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            names[i] = src[i].name;
+            if (names[i] == tracked)
+                track = i;
+        }
+    }
+    else
+    {
+        qsort(names, count, sizeof(char *), cmp_collate); // 키를 만들 메모리가 없음
+        if (tracked)
+            track = locate(names, count, tracked);
+    }
+
+    for (int i = 0; i < t; i++)
+        pool_free(&chunks[i].pool);
+    free(tmp);
+    free(entries);
+    return track;
+}
@@ -0,0 +1,13 @@
+#ifndef LIST_SORT_H
+#define LIST_SORT_H
+
+#define LIST_SORT_PARALLEL_MIN 32768 // 이보다 큰 목록은 여러 스레드로 키를 만들고 정렬
+#define LIST_SORT_THREADS_MAX 8
+
+// 이름 정렬 순서: 마지막 '/' 뒤 이름을 ASCII 대소문자 무시로 접은 뒤 현재 로캘(LC_COLLATE) 순서,
+// 같으면 원래 문자열 순서. setlocale 이후에 호출해야 한글 이름도 로캘 순서를 따름
+int list_collate(const char *a, const char *b);
+// names[track] 이 정렬 후 옮겨 간 위치를 돌려줌 (track 이 범위 밖이면 그대로)
+int list_sort(char **names, int count, int track);
+
+#endif
@@ -0,0 +1,90 @@
+#include "list_view.h"
+
+/* ============================================================
+   가상 목록 창
+   - 창에는 top 부터 창 높이만큼의 항목만 그림 (목록 길이와 무관한 비용)
+   - 선택이 창 밖으로 나가면 top 을 옮겨 보이는 구간만 다시 그림
+     (창에 idlok 가 켜져 있으면 ncurses 가 한 줄 이동을 터미널 스크롤로 보냄)
+   - 같은 구간 안에서 움직이면 이전/새 선택 줄만 다시 그림
+   - 목록이 창보다 길면 아래 테두리에 현재 위치를 표시 (다 받지 않은 목록은 개수 뒤에 '+')
+   ============================================================ */
+void listview_invalidate(ListView *v)
+{
+    v->valid = false;
+}
+
+int listview_rows(WINDOW *win)
+{
+    int rows = getmaxy(win) - 2;
+    return rows > 0 ? rows : 1;
+}
+
+// 항목 i 를 창의 해당 줄에 그림. 목록 끝을 지난 줄은 비움
+static void draw_row(WINDOW *win, int top, char *const *items, const int *map, int count,
+                     int i, int selected, bool focused)
+{
+    int w = getmaxx(win);
+    int row = i - top + 1;
+    if (i < top || row > listview_rows(win))
+        return;
+    wmove(win, row, 2);
+    if (i < count)
+    {
+        int sel = (i == selected);
+        if (sel && focused) wattron(win, A_REVERSE);
+        wprintw(win, "%c %.*s", sel ? '>' : ' ', w - 5, items[map ? map[i] : i]);
+        if (sel && focused) wattroff(win, A_REVERSE);
+    }
+    // 이전에 그린 글자나 반전 막대가 남지 않도록 오른쪽 테두리 앞까지 채움
+    for (int x = getcurx(win); x < w - 1; x++)
+        waddch(win, ' ');
+}
+
+static void draw_position(WINDOW *win, int count, int selected, bool partial)
+{
+    int h, w;
+    getmaxyx(win, h, w);
+    mvwhline(win, h - 1, 1, ACS_HLINE, w - 2);
+    if ((count > h - 2 || partial) && w > 24)
+        mvwprintw(win, h - 1, w - 22, " %d/%d%s ", selected + 1, count, partial ? "+" : "");
+}
+
+void listview_draw(WINDOW *win, ListView *v, const char *label, const char *path,
+                   char *const *items, const int *map, int count, int selected, bool focused)
+{
+    int rows = listview_rows(win);
+    int top = v->top;
+    if (selected >= 0 && selected < top)
+        top = selected;
+    else if (selected >= top + rows)
+        top = selected - rows + 1;
+    if (top > count - rows)
+        top = count - rows; // 목록이 줄었으면 아래에 빈 줄이 생기지 않게
+    if (top < 0)
+        top = 0;
+
+    if (!v->valid)
+    {
+        werase(win);
+        box(win, 0, 0);
+        mvwprintw(win, 0, 2, " %s: %s ", label, path);
+    }
+    if (!v->valid || top != v->top)
+    {
+        for (int i = top; i < top + rows; i++)
+            draw_row(win, top, items, map, count, i, selected, focused);
+    }
+    else if (v->selected != selected || v->focused != focused)
+    {
+        draw_row(win, top, items, map, count, v->selected, selected, focused);
+        draw_row(win, top, items, map, count, selected, selected, focused);
+    }
+    if (!v->valid || v->selected != selected)
+        draw_position(win, count, selected, v->partial);
+
+    v->top = top;
+    v->valid = true;
+    v->selected = selected;
+    v->focused = focused;
+    wnoutrefresh(win);
+}
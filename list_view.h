@@ -0,0 +1,23 @@
+#ifndef LIST_VIEW_H
+#define LIST_VIEW_H
+
+#include <ncurses.h>
+#include <stdbool.h>
+
+// 목록 창 하나의 화면 상태. 항목이 몇 개든 창에 보이는 구간만 그림
+typedef struct {
+    int top;        // 창 첫 줄에 보이는 항목 번호
+    bool valid;     // false 면 다음 그리기에서 창 전체를 다시 그림
+    int selected;   // 마지막으로 그렸을 때의 선택 위치
+    bool focused;
+    bool partial;   // 목록을 아직 다 받지 않음 (위치 표시에 '+', 그리기 전에 목록 쪽에서 채움)
+} ListView;
+
+void listview_invalidate(ListView *v); // 목록 내용이 바뀌었을 때
+int listview_rows(WINDOW *win);        // 창에 보이는 항목 수 (PgUp/PgDn 단위)
+// 선택 항목이 보이도록 top 을 맞추고 바뀐 줄만 그린 뒤 wnoutrefresh (doupdate 는 호출자)
+// map 이 있으면 i 번째 줄에 items[map[i]] 를 그림 (필터 결과), count/selected 는 줄 기준
+void listview_draw(WINDOW *win, ListView *v, const char *label, const char *path,
+                   char *const *items, const int *map, int count, int selected, bool focused);
+
+#endif
@@ -0,0 +1,148 @@
+#define _DEFAULT_SOURCE // dirent.d_type, DT_*
+#include "local_scan.h"
+#include "str_pool.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/* ============================================================
+   로컬 디렉토리 스캔
+   - readdir 가 알려 주는 d_type 으로 바로 구분 (항목마다 stat 하지 않음)
+   - d_type 을 모르거나 심볼릭 링크면 열어 둔 디렉토리 fd 기준 fstatat
+     (경로를 다시 만들고 처음부터 찾아 내려가지 않음)
+   - stat 한 번이 수 ms 씩 걸리는 네트워크 파일시스템을 위해, 확인할 항목이
+     많으면 여러 스레드가 번호를 나눠 가져가며 stat
+   ============================================================ */
+static int scan_threads = 1;
+
+void local_scan_set_threads(int n)
+{
+    if (n < 1)
+        n = 1;
+    if (n > LOCAL_SCAN_THREADS_MAX)
+        n = LOCAL_SCAN_THREADS_MAX;
+    scan_threads = n;
+}
+
+static bool stat_is_dir(int dfd, const char *name)
+{
+    struct stat st;
+    return fstatat(dfd, name, &st, 0) == 0 && S_ISDIR(st.st_mode); // 링크는 따라감
+}
+
+// 0: 디렉토리 아님, 1: 디렉토리, -1: stat 으로 확인해야 함
+static int dirent_kind(const struct dirent *e)
+{
+#ifdef DT_DIR
+    if (e->d_type == DT_DIR)
+        return 1;
+    if (e->d_type != DT_UNKNOWN && e->d_type != DT_LNK)
+        return 0;
+#else
+    (void)e;
+#endif
+    return -1;
+}
+
+typedef struct
+{
+    int dfd;
+    char **names; // stat 으로 확인할 이름들
+    bool *is_dir;
+    int count;
+    atomic_int next; // 다음에 가져갈 번호
+} StatJob;
+
+static void *stat_worker(void *arg)
+{
+    StatJob *job = arg;
+    int i;
+    while ((i = atomic_fetch_add(&job->next, 1)) < job->count)
+        job->is_dir[i] = stat_is_dir(job->dfd, job->names[i]);
+    return NULL;
+}
+
+// 모아 둔 이름들을 stat. 스레드를 못 만들면 호출한 스레드가 나머지를 모두 처리
+static void stat_all(StatJob *job)
+{
+    int workers = scan_threads - 1;
+    if (job->count < LOCAL_SCAN_PARALLEL_MIN)
+        workers = 0;
+    pthread_t tid[LOCAL_SCAN_THREADS_MAX];
+    int started = 0;
+    for (int i = 0; i < workers; i++)
+        if (pthread_create(&tid[started], NULL, stat_worker, job) == 0)
+            started++;
+    stat_worker(job);
+    for (int i = 0; i < started; i++)
+        pthread_join(tid[i], NULL);
+}
+
+bool local_scan_dirs(const char *dir_abs, LocalScanFn fn, void *ctx)
+{
+    DIR *d = opendir(dir_abs);
+    if (!d)
+        return false;
+    int dfd = dirfd(d);
+
+    StrPool pool = {0};
+    StatJob job = {.dfd = dfd};
+    int cap = 0;
+    bool defer = (scan_threads > 1); // 한 스레드면 모으지 않고 바로 stat
+
+    struct dirent *e;
+    while ((e = readdir(d)))
+    {
+        const char *name = e->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+            continue;
+        int kind = dirent_kind(e);
+        if (kind == 1 || (kind < 0 && !defer && stat_is_dir(dfd, name)))
+        {
+            fn(ctx, name);
+        }
+        else if (kind < 0 && defer)
+        {
+            if (job.count == cap)
+            {
+                cap = cap ? cap * 2 : 256;
+                char **names = realloc(job.names, sizeof(char *) * (size_t)cap);
+                if (!names)
+                {
+                    defer = false; // 메모리가 없으면 남은 항목은 바로 stat
+                    if (stat_is_dir(dfd, name))
+                        fn(ctx, name);
+                    continue;
+                }
+                job.names = names;
+            }
+            char *copy = pool_strdup(&pool, name);
+            if (copy)
+                job.names[job.count++] = copy;
+        }
+    }
+
+    if (job.count > 0 && (job.is_dir = calloc((size_t)job.count, sizeof(bool))))
+    {
+        stat_all(&job);
+        for (int i = 0; i < job.count; i++)
+            if (job.is_dir[i])
+                fn(ctx, job.names[i]);
+    }
+    else
+    {
+        for (int i = 0; i < job.count; i++)
+            if (stat_is_dir(dfd, job.names[i]))
+                fn(ctx, job.names[i]);
+    }
+
+    free(job.is_dir);
+    free(job.names);
+    pool_free(&pool);
+    closedir(d);
+    return true;
+}
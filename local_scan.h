@@ -0,0 +1,17 @@
+#ifndef LOCAL_SCAN_H
+#define LOCAL_SCAN_H
+
+#include <stdbool.h>
+
+#define LOCAL_SCAN_THREADS_MAX 32
+#define LOCAL_SCAN_PARALLEL_MIN 64 // stat 이 필요한 항목이 이보다 적으면 스레드 없이 확인
+
+// 하위 디렉토리 이름 하나 (호출한 스레드에서 불림, 순서는 정해지지 않음)
+typedef void (*LocalScanFn)(void *ctx, const char *name);
+
+// d_type 을 모르는 항목(네트워크 파일시스템 등)의 stat 을 n 개 스레드로 나눠 확인 (기본 1)
+void local_scan_set_threads(int n);
+// dir_abs 의 하위 디렉토리(. 과 .. 제외, 디렉토리를 가리키는 링크 포함)를 fn 으로 넘김. 열 수 없으면 false
+bool local_scan_dirs(const char *dir_abs, LocalScanFn fn, void *ctx);
+
+#endif
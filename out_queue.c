@@ -0,0 +1,146 @@
+#define _GNU_SOURCE
+#include "out_queue.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#define CHUNK_MIN 4096
+#define SEND_IOV_MAX 64
+
+struct OutChunk {
+    OutChunk *next;
+    size_t len, cap;
+    size_t off;      // 이미 보낸 바이트
+    bool droppable;
+    char data[];
+};
+
+/* ============================================================
+   연결별 송신 큐
+   - 일반 응답은 꼬리 청크에 이어 붙여 작은 줄이 많아도 할당이 적음
+   - 브로드캐스트는 메시지마다 별도 청크로 두어 느린 수신자 정책에서
+     개별로 버릴 수 있게 함
+   ============================================================ */
+bool outq_push(OutQueue *q, const char *data, size_t len, bool droppable)
+{
+    if (len == 0)
+        return true;
+
+    OutChunk *t = q->tail;
+    if (!droppable && t && !t->droppable && t->cap - t->len >= len)
+    {
+        memcpy(t->data + t->len, data, len);
+        t->len += len;
+        q->bytes += len;
+        return true;
+    }
+
+    size_t cap = droppable ? len : (len > CHUNK_MIN ? len : CHUNK_MIN);
+    OutChunk *c = malloc(sizeof(*c) + cap);
+    if (!c)
+        return false;
+    c->next = NULL;
+    c->len = len;
+    c->cap = cap;
+    c->off = 0;
+    c->droppable = droppable;
+    memcpy(c->data, data, len);
+
+    if (t)
+        t->next = c;
+    else
+        q->head = c;
+    q->tail = c;
+    q->bytes += len;
+    q->chunks++;
+    return true;
+}
+
+size_t outq_drop_pending(OutQueue *q)
+{
+    size_t dropped = 0;
+    OutChunk **pp = &q->head;
+    OutChunk *last = NULL;
+    while (*pp)
+    {
+        OutChunk *c = *pp;
+        if (c->droppable && c->off == 0)
+        {
+            *pp = c->next;
+            q->bytes -= c->len;
+            q->chunks--;
+            free(c);
+            dropped++;
+            continue;
+        }
+        last = c;
+        pp = &c->next;
+    }
+    q->tail = last;
+    return dropped;
+}
+
+int outq_send(OutQueue *q, int fd, size_t *sent_out)
+{
+    *sent_out = 0;
+    while (q->head)
+    {
+        struct iovec iov[SEND_IOV_MAX];
+        int n = 0;
+        for (OutChunk *c = q->head; c && n < SEND_IOV_MAX; c = c->next)
+        {
+            iov[n].iov_base = c->data + c->off;
+            iov[n].iov_len = c->len - c->off;
+            n++;
+        }
+
+        struct msghdr mh = {0};
+        mh.msg_iov = iov;
+        mh.msg_iovlen = n;
+        ssize_t sent = sendmsg(fd, &mh, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return -1;
+        }
+        *sent_out += (size_t)sent;
+        q->bytes -= (size_t)sent;
+
+        // 다 보낸 청크 해제
+        size_t left = (size_t)sent;
+        while (left > 0 && q->head)
+        {
+            OutChunk *c = q->head;
+            size_t rem = c->len - c->off;
+            if (left < rem)
+            {
+                c->off += left;
+                break;
+            }
+            left -= rem;
+            q->head = c->next;
+            q->chunks--;
+            free(c);
+        }
+        if (!q->head)
+            q->tail = NULL;
+    }
+    return 0;
+}
+
+void outq_clear(OutQueue *q)
+{
+    OutChunk *c = q->head;
+    while (c)
+    {
+        OutChunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    memset(q, 0, sizeof(*q));
+}
@@ -0,0 +1,21 @@
+#ifndef OUT_QUEUE_H
+#define OUT_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+typedef struct OutChunk OutChunk;
+
+typedef struct {
+    OutChunk *head, *tail;
+    size_t bytes;   // 아직 보내지 못한 바이트 수 (큐 깊이)
+    size_t chunks;  // 대기 중인 청크 수
+} OutQueue;
+
+bool outq_push(OutQueue *q, const char *data, size_t len, bool droppable); // droppable: 브로드캐스트처럼 버려도 되는 메시지
+size_t outq_drop_pending(OutQueue *q); // 전송을 시작하지 않은 droppable 청크 제거, 제거한 개수 반환
+int outq_send(OutQueue *q, int fd, size_t *sent); // writev로 보낼 수 있는 만큼 전송, 보낸 바이트 수는 *sent (치명적 오류 시 -1, 그 전까지 보낸 양도 *sent 에 들어감)
+void outq_clear(OutQueue *q);
+
+#endif
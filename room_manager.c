@@ -0,0 +1,235 @@
+#include "room_manager.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+   방 → 멤버 색인
+   - 방 이름 해시 테이블 (체이닝, 방 수가 버킷 수를 넘으면 두 배로)
+   - 방마다 멤버 배열, 연결마다 구독 배열을 두고 서로의 위치를 기억해
+     구독/해제가 O(1) (빈 자리는 마지막 항목으로 채움)
+   - 메시지 전달은 전체 연결이 아니라 그 방 멤버만 순회
+   - 멤버가 없어진 방은 바로 해제
+   ============================================================ */
+typedef struct
+{
+    ClientSlot *slot;
+    int sub; // slot->subs 에서의 위치
+} RoomMember;
+
+struct Room
+{
+    Room *next; // 같은 버킷의 다음 방
+    RoomMember *members;
+    int count, cap;
+    char name[];
+};
+
+static Room **buckets = NULL;
+static size_t bucket_count = 0; // 항상 2의 거듭제곱
+static int rooms = 0;
+
+static uint64_t hash_name(const char *s)
+{
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    for (; *s; s++)
+        h = (h ^ (unsigned char)*s) * 1099511628211ULL;
+    return h;
+}
+
+static Room **bucket_of(const char *name)
+{
+    return &buckets[hash_name(name) & (bucket_count - 1)];
+}
+
+static Room *room_find(const char *name)
+{
+    if (!buckets)
+        return NULL;
+    for (Room *r = *bucket_of(name); r; r = r->next)
+        if (strcmp(r->name, name) == 0)
+            return r;
+    return NULL;
+}
+
+static bool table_grow(void)
+{
+    size_t ncount = bucket_count ? bucket_count * 2 : 64;
+    Room **nb = calloc(ncount, sizeof(*nb));
+    if (!nb)
+        return false;
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        Room *r = buckets[i];
+        while (r)
+        {
+            Room *next = r->next;
+            Room **b = &nb[hash_name(r->name) & (ncount - 1)];
+            r->next = *b;
+            *b = r;
+            r = next;
+        }
+    }
+    free(buckets);
+    buckets = nb;
+    bucket_count = ncount;
+    return true;
+}
+
+static Room *room_create(const char *name)
+{
+    if ((size_t)rooms >= bucket_count && !table_grow() && !buckets)
+        return NULL;
+    size_t len = strlen(name);
+    Room *r = calloc(1, sizeof(*r) + len + 1);
+    if (!r)
+        return NULL;
+    memcpy(r->name, name, len + 1);
+    Room **b = bucket_of(name);
+    r->next = *b;
+    *b = r;
+    rooms++;
+    return r;
+}
+
+static void room_destroy(Room *r)
+{
+    for (Room **p = bucket_of(r->name); *p; p = &(*p)->next)
+    {
+        if (*p == r)
+        {
+            *p = r->next;
+            break;
+        }
+    }
+    free(r->members);
+    free(r);
+    rooms--;
+}
+
+static int sub_index(const ClientSlot *slot, const char *name)
+{
+    for (int i = 0; i < slot->sub_count; i++)
+        if (strcmp(slot->subs[i].room->name, name) == 0)
+            return i;
+    return -1;
+}
+
+bool room_is_member(const ClientSlot *slot, const char *name)
+{
+    return sub_index(slot, name) >= 0;
+}
+
+bool room_subscribe(ClientSlot *slot, const char *name)
+{
+    if (room_is_member(slot, name))
+        return true;
+    if (slot->sub_count >= ROOM_SUBS_MAX)
+        return false;
+
+    if (slot->sub_count == slot->sub_cap)
+    {
+        int cap = slot->sub_cap ? slot->sub_cap * 2 : 4;
+        RoomSub *ns = realloc(slot->subs, sizeof(*ns) * cap);
+        if (!ns)
+            return false;
+        slot->subs = ns;
+        slot->sub_cap = cap;
+    }
+
+    Room *r = room_find(name);
+    if (!r && !(r = room_create(name)))
+        return false;
+    if (r->count == r->cap)
+    {
+        int cap = r->cap ? r->cap * 2 : 4;
+        RoomMember *nm = realloc(r->members, sizeof(*nm) * cap);
+        if (!nm)
+        {
+            if (r->count == 0)
+                room_destroy(r);
+            return false;
+        }
+        r->members = nm;
+        r->cap = cap;
+    }
+
+    r->members[r->count] = (RoomMember){slot, slot->sub_count};
+    slot->subs[slot->sub_count] = (RoomSub){r, r->count};
+    r->count++;
+    slot->sub_count++;
+    return true;
+}
+
+static void remove_sub(ClientSlot *slot, int i)
+{
+    RoomSub s = slot->subs[i];
+    Room *r = s.room;
+
+    // 방 쪽: 마지막 멤버를 빈 자리로 옮기고 그 연결의 구독 기록을 고침
+    int last = --r->count;
+    if (s.index != last)
+    {
+        r->members[s.index] = r->members[last];
+        RoomMember *m = &r->members[s.index];
+        m->slot->subs[m->sub].index = s.index;
+    }
+
+    // 연결 쪽: 마지막 구독을 빈 자리로 옮기고 그 방의 멤버 기록을 고침
+    int slast = --slot->sub_count;
+    if (i != slast)
+    {
+        slot->subs[i] = slot->subs[slast];
+        RoomSub *moved = &slot->subs[i];
+        moved->room->members[moved->index].sub = i;
+    }
+
+    if (r->count == 0)
+        room_destroy(r);
+}
+
+bool room_unsubscribe(ClientSlot *slot, const char *name)
+{
+    int i = sub_index(slot, name);
+    if (i < 0)
+        return false;
+    remove_sub(slot, i);
+    return true;
+}
+
+void room_leave_all(ClientSlot *slot)
+{
+    while (slot->sub_count > 0)
+        remove_sub(slot, slot->sub_count - 1);
+    free(slot->subs);
+    slot->subs = NULL;
+    slot->sub_cap = 0;
+}
+
+int room_for_each(const char *name, const ClientSlot *except, RoomVisit visit, void *ctx)
+{
+    Room *r = room_find(name);
+    if (!r)
+        return 0;
+    int sent = 0;
+    for (int i = 0; i < r->count; i++)
+    {
+        ClientSlot *m = r->members[i].slot;
+        if (m != except)
+        {
+            visit(m, ctx);
+            sent++;
+        }
+    }
+    return sent;
+}
+
+int room_count(void)
+{
+    return rooms;
+}
+
+const char *room_name(const Room *room)
+{
+    return room->name;
+}
@@ -0,0 +1,32 @@
+#ifndef ROOM_MANAGER_H
+#define ROOM_MANAGER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "client_registry.h"
+
+#define ROOM_SUBS_MAX 64 // 한 연결이 동시에 구독할 수 있는 방 수
+
+typedef struct Room Room;
+
+// 방 구독 (연결 쪽 기록). index 는 방 멤버 배열에서의 위치
+typedef struct RoomSub
+{
+    Room *room;
+    int index;
+} RoomSub;
+
+// 방 멤버 한 명에게 보내는 콜백
+typedef void (*RoomVisit)(ClientSlot *member, void *ctx);
+
+bool room_subscribe(ClientSlot *slot, const char *name);   // 이미 구독 중이면 true, 상한 초과/메모리 부족이면 false
+bool room_unsubscribe(ClientSlot *slot, const char *name); // 구독 중이 아니었으면 false
+void room_leave_all(ClientSlot *slot);                     // 연결 종료 시
+bool room_is_member(const ClientSlot *slot, const char *name);
+// 방 멤버에게만 전달 (방 크기에 비례). except 는 건너뜀, 방이 없으면 0
+int room_for_each(const char *name, const ClientSlot *except, RoomVisit visit, void *ctx);
+int room_count(void);
+const char *room_name(const Room *room);
+
+#endif
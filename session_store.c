@@ -0,0 +1,223 @@
+#include "session_store.h"
+#include "auth.h"
+#include "room_manager.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/random.h>
+
+#define SESSION_BUCKETS 1024      // 토큰 해시 버킷 수 (2의 거듭제곱)
+#define SESSION_SWEEP_EVERY 64    // 세션을 이만큼 만들 때마다 만료된 것 정리
+
+/* ============================================================
+   세션 토큰
+   - 로그인에 성공하면 16바이트 난수 토큰을 발급
+   - 연결 중에는 그 연결(owner)을 가리키고, 끊기면 현재 방/구독 목록을
+     보관한 채 TTL 동안 RESUME 을 기다림
+   - RESUME 은 비밀번호 확인 없이 세션을 되살리되, 계정이 지워졌거나 잠겼으면 거절
+   - 만료된 세션은 주기적으로 정리하고, 그 전에 조회되면 그 자리에서 지움
+   ============================================================ */
+typedef struct Session
+{
+    struct Session *next;          // 같은 버킷
+    char token[SESSION_TOKEN_LEN + 1];
+    char username[64];
+    int permission_level;
+    ClientSlot *owner;             // 연결 중이면 그 연결, 아니면 NULL
+    time_t expires;                // owner 가 없을 때만 의미 있음
+    char room[ROOM_NAME_MAX];      // 현재 방
+    char *subs;                    // 구독 중인 방 이름들 (NUL 로 구분)
+    int sub_count;
+} Session;
+
+static Session *buckets[SESSION_BUCKETS];
+static int ttl = SESSION_TTL_DEFAULT;
+static int sessions = 0;
+static unsigned created_since_sweep = 0;
+
+void session_init(int ttl_sec)
+{
+    ttl = ttl_sec > 0 ? ttl_sec : SESSION_TTL_DEFAULT;
+}
+
+int session_ttl(void)
+{
+    return ttl;
+}
+
+int session_count(void)
+{
+    return sessions;
+}
+
+// 토큰은 난수이므로 앞 16자리를 그대로 해시로 씀
+static Session **bucket_of(const char *token)
+{
+    uint64_t h = 0;
+    for (int i = 0; i < 16 && token[i]; i++)
+        h = (h << 4) | (uint64_t)(token[i] <= '9' ? token[i] - '0' : (token[i] | 0x20) - 'a' + 10);
+    return &buckets[h & (SESSION_BUCKETS - 1)];
+}
+
+// 토큰의 세션을 가리키는 링크 (없으면 NULL)
+static Session **session_link(const char *token)
+{
+    if (strlen(token) != SESSION_TOKEN_LEN)
+        return NULL;
+    for (Session **link = bucket_of(token); *link; link = &(*link)->next)
+        if (strcmp((*link)->token, token) == 0)
+            return link;
+    return NULL;
+}
+
+static Session *session_find(const char *token)
+{
+    Session **link = session_link(token);
+    return link ? *link : NULL;
+}
+
+static void session_free(Session **link)
+{
+    Session *s = *link;
+    *link = s->next;
+    free(s->subs);
+    free(s);
+    sessions--;
+}
+
+static bool session_expired(const Session *s, time_t now)
+{
+    return !s->owner && s->expires <= now;
+}
+
+static void sweep_expired(time_t now)
+{
+    for (int i = 0; i < SESSION_BUCKETS; i++)
+    {
+        Session **link = &buckets[i];
+        while (*link)
+        {
+            if (session_expired(*link, now))
+                session_free(link);
+            else
+                link = &(*link)->next;
+        }
+    }
+}
+
+// slot 의 현재 방과 구독 목록을 세션에 보관
+static void save_rooms(Session *s, const ClientSlot *slot)
+{
+    size_t len = 0;
+    for (int i = 0; i < slot->sub_count; i++)
+        len += strlen(room_name(slot->subs[i].room)) + 1;
+
+    char *buf = len ? malloc(len) : NULL;
+    size_t off = 0;
+    int count = 0;
+    if (buf)
+    {
+        for (int i = 0; i < slot->sub_count; i++)
+        {
+            const char *name = room_name(slot->subs[i].room);
+            size_t n = strlen(name) + 1;
+            memcpy(buf + off, name, n);
+            off += n;
+            count++;
+        }
+    }
+    free(s->subs);
+    s->subs = buf;
+    s->sub_count = count;
+    snprintf(s->room, sizeof(s->room), "%s", slot->room);
+}
+
+bool session_create(ClientSlot *slot)
+{
+    unsigned char raw[SESSION_TOKEN_LEN / 2];
+    if (getrandom(raw, sizeof(raw), 0) != (ssize_t)sizeof(raw))
+        return false;
+
+    Session *s = calloc(1, sizeof(*s));
+    if (!s)
+        return false;
+    for (size_t i = 0; i < sizeof(raw); i++)
+        snprintf(s->token + i * 2, 3, "%02x", raw[i]);
+    snprintf(s->username, sizeof(s->username), "%s", slot->username);
+    s->permission_level = slot->permission_level;
+    s->owner = slot;
+
+    Session **b = bucket_of(s->token);
+    s->next = *b;
+    *b = s;
+    sessions++;
+    memcpy(slot->session, s->token, sizeof(slot->session));
+
+    if (++created_since_sweep >= SESSION_SWEEP_EVERY)
+    {
+        created_since_sweep = 0;
+        sweep_expired(time(NULL));
+    }
+    return true;
+}
+
+bool session_resume(ClientSlot *slot, const char *token, ClientSlot **replaced)
+{
+    *replaced = NULL;
+    Session **link = session_link(token);
+    if (!link)
+        return false;
+    Session *s = *link;
+    UserAccount acct;
+    bool usable = get_user_info(s->username, &acct) && !acct.locked;
+    if (session_expired(s, time(NULL)) || (!usable && !s->owner))
+    {
+        session_free(link); // 만료됐거나 계정을 더 쓸 수 없는 세션은 조회한 김에 지움
+        return false;
+    }
+    if (!usable)
+        return false;
+
+    // 이전 연결이 아직 정리되지 않았으면 (끊긴 걸 서버가 모르는 경우) 그 연결의 구독을 옮겨 오고,
+    // 같은 세션으로 두 연결이 메시지를 받지 않도록 이전 연결은 호출한 쪽이 닫게 돌려줌
+    if (s->owner && s->owner != slot)
+    {
+        save_rooms(s, s->owner);
+        room_leave_all(s->owner);
+        s->owner->session[0] = '\0';
+        *replaced = s->owner;
+    }
+
+    s->permission_level = acct.permission_level; // 로그인 이후 바뀐 권한을 따름
+    snprintf(slot->username, sizeof(slot->username), "%s", s->username);
+    slot->permission_level = s->permission_level;
+    memcpy(slot->session, s->token, sizeof(slot->session));
+    snprintf(slot->room, sizeof(slot->room), "%s", s->room);
+    const char *name = s->subs;
+    for (int i = 0; i < s->sub_count; i++)
+    {
+        room_subscribe(slot, name);
+        name += strlen(name) + 1;
+    }
+    free(s->subs);
+    s->subs = NULL;
+    s->sub_count = 0;
+    s->owner = slot;
+    return true;
+}
+
+void session_detach(ClientSlot *slot)
+{
+    if (!slot->session[0])
+        return;
+    Session *s = session_find(slot->session);
+    if (s && s->owner == slot)
+    {
+        save_rooms(s, slot);
+        s->owner = NULL;
+        s->expires = time(NULL) + ttl;
+    }
+    slot->session[0] = '\0';
+}
@@ -0,0 +1,19 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <stdbool.h>
+
+#include "client_registry.h"
+
+#define SESSION_TTL_DEFAULT 3600 // 연결이 끊긴 뒤 세션을 유지하는 시간 (초)
+
+void session_init(int ttl_sec);        // ttl_sec <= 0 이면 기본값
+int session_ttl(void);
+bool session_create(ClientSlot *slot); // 로그인한 slot 에 새 토큰 발급 (slot->session 에 기록)
+// 토큰으로 신원/권한/현재 방/구독을 slot 에 복원. 토큰이 없거나 만료됐거나 계정이 없거나 잠겼으면 false
+// 세션이 아직 다른 연결에 붙어 있었으면 구독을 옮겨 오고 그 연결을 *replaced 로 돌려줌 (호출한 쪽이 닫음)
+bool session_resume(ClientSlot *slot, const char *token, ClientSlot **replaced);
+void session_detach(ClientSlot *slot); // 연결 종료 시 방 목록을 저장하고 만료 시계 시작
+int session_count(void);
+
+#endif
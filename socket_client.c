@@ -1,11 +1,289 @@
 #include "socket_client.h"
+#include "line_framer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#define MAX_RESPONSE_LINE 8192
+#define RING_CAP 1024 // 줄 큐 용량 (2의 거듭제곱)
 
 int sockfd = -1;
+static socket_push_fn push_fn = NULL;
+static void *push_ctx = NULL;
+
+/* ============================================================
+   수신 스레드
+   - 소켓은 수신 스레드 하나만 읽고, 줄 단위로 나눠 종류별 큐에 넣음
+     (명령 응답 / 채팅 푸시 "MSG ..." / 안내 "INFO: ...")
+   - 큐는 생산자 하나, 소비자 하나인 잠금 없는 원형 버퍼
+   - 줄을 넣으면 깨우기 fd 로 UI 스레드를 깨움 (UI 는 이 fd 를 poll 가능)
+   - 큐가 가득 차도 수신 스레드는 잠들지 않고, 수신 스레드 전용 넘침 목록에 쌓아 두었다가
+     UI 가 줄을 꺼내며 반대쪽 깨우기 fd 로 알려 주면 도착 순서대로 옮김
+     (UI 가 바빠도 소켓은 계속 읽으므로 서버 쪽 큐가 차서 메시지를 잃지 않음)
+   - 푸시 콜백은 항상 UI 스레드에서 호출되므로 채팅 상태에 잠금이 필요 없음
+   ============================================================ */
+typedef struct {
+    char *slots[RING_CAP];
+    _Atomic size_t head; // 소비자가 다음에 꺼낼 위치
+    _Atomic size_t tail; // 생산자가 다음에 넣을 위치
+} LineRing;
+
+// 깨우기 fd: Linux 는 eventfd 하나, 그 밖에는 self-pipe (읽는 쪽/쓰는 쪽)
+typedef struct {
+    int rfd, wfd;
+} Wakeup;
+
+// 큐에 들어가지 못한 줄 (수신 스레드만 만짐, 도착 순서대로 옮김)
+typedef struct SpillLine {
+    struct SpillLine *next;
+    LineRing *ring;
+    char *line;
+} SpillLine;
+
+static LineRing replies, chats, notices;
+static SpillLine *spill_head = NULL, *spill_tail = NULL;
+static Wakeup ui_wake = {-1, -1}; // 수신 스레드 → UI: 새 줄이 있음
+static Wakeup rx_wake = {-1, -1}; // UI → 수신 스레드: 큐에 자리가 생김
+static pthread_t rx_thread;
+static bool rx_running = false;
+static atomic_bool rx_closed;
+static atomic_bool rx_stop;    // socket_close 요청
+static atomic_bool rx_waiting; // 수신 스레드가 넘친 줄을 옮길 큐 자리를 기다림
+
+static bool wakeup_open(Wakeup *w) {
+#ifdef __linux__
+    w->rfd = w->wfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return w->rfd >= 0;
+#else
+    int p[2];
+    if (pipe(p) != 0)
+        return false;
+    for (int i = 0; i < 2; i++) {
+        fcntl(p[i], F_SETFL, fcntl(p[i], F_GETFL) | O_NONBLOCK);
+        fcntl(p[i], F_SETFD, FD_CLOEXEC);
+    }
+    w->rfd = p[0];
+    w->wfd = p[1];
+    return true;
+#endif
+}
+
+static void wakeup_signal(Wakeup *w) {
+#ifdef __linux__
+    uint64_t one = 1;
+#else
+    char one = 1; // 파이프가 가득 차 있으면 이미 깨울 것이 남아 있으므로 실패해도 됨
+#endif
+    ssize_t n = write(w->wfd, &one, sizeof(one));
+    (void)n;
+}
+
+static void wakeup_drain(Wakeup *w) {
+    char buf[64]; // eventfd 는 한 번에 0 으로, 파이프는 빌 때까지
+    while (read(w->rfd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+static void wakeup_close(Wakeup *w) {
+    if (w->rfd >= 0)
+        close(w->rfd);
+    if (w->wfd >= 0 && w->wfd != w->rfd)
+        close(w->wfd);
+    w->rfd = w->wfd = -1;
+}
+
+static bool ring_put(LineRing *r, char *line) {
+    size_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (t - atomic_load_explicit(&r->head, memory_order_acquire) == RING_CAP)
+        return false;
+    r->slots[t & (RING_CAP - 1)] = line;
+    atomic_store_explicit(&r->tail, t + 1, memory_order_release);
+    return true;
+}
+
+static char *ring_get(LineRing *r) {
+    size_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (h == atomic_load_explicit(&r->tail, memory_order_acquire))
+        return NULL;
+    char *line = r->slots[h & (RING_CAP - 1)];
+    atomic_store_explicit(&r->head, h + 1, memory_order_release);
+    return line;
+}
+
+// UI 스레드 쪽에서 꺼냄. 수신 스레드가 자리를 기다리고 있으면 깨움
+static char *ring_take(LineRing *r) {
+    char *line = ring_get(r);
+    if (line) {
+        atomic_thread_fence(memory_order_seq_cst); // head 갱신 뒤에 rx_waiting 을 읽음
+        if (atomic_load_explicit(&rx_waiting, memory_order_relaxed))
+            wakeup_signal(&rx_wake);
+    }
+    return line;
+}
+
+static void ring_clear(LineRing *r) {
+    char *line;
+    while ((line = ring_get(r)))
+        free(line);
+}
+
+static void wake_ui(void) {
+    wakeup_signal(&ui_wake);
+}
+
+// 넘침 목록을 앞에서부터 큐로 옮김. 다 옮기지 못하면 true
+static bool spill_flush(void) {
+    bool moved = false;
+    while (spill_head && ring_put(spill_head->ring, spill_head->line)) {
+        SpillLine *s = spill_head;
+        spill_head = s->next;
+        free(s);
+        moved = true;
+    }
+    if (!spill_head)
+        spill_tail = NULL;
+    if (moved)
+        wake_ui();
+    return spill_head != NULL;
+}
+
+// 줄을 큐에 넣되, 앞서 넘친 줄이 있거나 큐가 가득 차면 넘침 목록 뒤에 붙임
+static void spill_put(LineRing *r, char *line) {
+    if (!spill_head && ring_put(r, line))
+        return;
+    SpillLine *s = malloc(sizeof(*s));
+    if (!s) {
+        free(line);
+        return;
+    }
+    s->next = NULL;
+    s->ring = r;
+    s->line = line;
+    if (spill_tail)
+        spill_tail->next = s;
+    else
+        spill_head = s;
+    spill_tail = s;
+}
+
+static void spill_clear(void) {
+    while (spill_head) {
+        SpillLine *s = spill_head;
+        spill_head = s->next;
+        free(s->line);
+        free(s);
+    }
+    spill_tail = NULL;
+}
+
+static LineRing *ring_for(const char *line) {
+    if (strncmp(line, "MSG ", 4) == 0)
+        return &chats;
+    if (strncmp(line, "INFO:", 5) == 0)
+        return &notices;
+    return &replies;
+}
+
+// 넘친 줄이 큐로 옮겨질 자리를 기다림. with_socket 이면 소켓에 읽을 것이 생겨도 깨어남.
+// 소켓이 읽을 수 있게 됐으면 true
+static bool rx_wait_room(bool with_socket) {
+    struct pollfd p[2] = {{rx_wake.rfd, POLLIN, 0}, {sockfd, POLLIN, 0}};
+    atomic_store_explicit(&rx_waiting, true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst); // 표시를 켠 뒤에 큐를 다시 봄
+    if (spill_flush() && poll(p, with_socket ? 2 : 1, -1) > 0 && (p[0].revents & POLLIN))
+        wakeup_drain(&rx_wake);
+    atomic_store(&rx_waiting, false);
+    return p[1].revents != 0;
+}
+
+static void *rx_main(void *arg) {
+    (void)arg;
+    LineFramer f;
+    framer_init(&f, MAX_RESPONSE_LINE);
+    for (;;) {
+        // 넘친 줄이 남아 있으면 소켓과 큐 자리를 함께 기다림
+        if (spill_flush() && !rx_wait_room(true))
+            continue;
+
+        size_t room;
+        char *space = framer_space(&f, &room);
+        if (!space)
+            break;
+        ssize_t n = recv(sockfd, space, room, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        framer_commit(&f, (size_t)n);
+
+        // 큐가 가득 차도 잠들지 않고 넘침 목록에 쌓음 (응답과 푸시의 도착 순서는 유지)
+        char *line;
+        while ((line = framer_next(&f))) {
+            char *copy = strdup(line);
+            if (copy)
+                spill_put(ring_for(copy), copy);
+        }
+        wake_ui();
+    }
+    // 연결이 끊겨도 이미 받은 줄은 UI 가 가져가도록 넘김 (socket_close 요청이면 버림)
+    while (!atomic_load(&rx_stop) && spill_flush())
+        rx_wait_room(false);
+    framer_free(&f);
+    spill_clear();
+    atomic_store(&rx_closed, true);
+    wake_ui();
+    return NULL;
+}
+
+void socket_set_push_handler(socket_push_fn fn, void *ctx) {
+    push_fn = fn;
+    push_ctx = ctx;
+}
+
+int socket_event_fd(void) {
+    return ui_wake.rfd;
+}
+
+static void drain_event(void) {
+    wakeup_drain(&ui_wake);
+}
+
+// 쌓인 채팅/안내 줄을 푸시 콜백으로 넘김
+static void dispatch_pushes(void) {
+    LineRing *rings[] = {&chats, &notices};
+    for (size_t i = 0; i < sizeof(rings) / sizeof(rings[0]); i++) {
+        char *line;
+        while ((line = ring_take(rings[i]))) {
+            if (push_fn)
+                push_fn(line, push_ctx);
+            free(line);
+        }
+    }
+}
+
+// 기다리는 요청이 없는데 남아 있는 응답 줄 ("ERR: line too long", 늦게 온 ACK,
+// OK 뒤에 더 온 줄 등)은 다음 명령의 응답으로 넘기지 않고 푸시 콜백으로 넘겨 버림
+static void drop_stray_replies(void) {
+    char *line;
+    while ((line = ring_take(&replies))) {
+        if (push_fn)
+            push_fn(line, push_ctx);
+        free(line);
+    }
+}
 
 int socket_connect_to(const char *server_ip, int port) {
     struct sockaddr_in serv;
@@ -13,32 +291,90 @@ int socket_connect_to(const char *server_ip, int port) {
     serv.sin_family = AF_INET;
     serv.sin_port = htons(port);
     inet_pton(AF_INET, server_ip, &serv.sin_addr);
-    return connect(sockfd, (struct sockaddr*)&serv, sizeof(serv));
+    if (connect(sockfd, (struct sockaddr*)&serv, sizeof(serv)) < 0) {
+        close(sockfd);
+        sockfd = -1;
+        return -1;
+    }
+
+    atomic_store(&rx_closed, false);
+    atomic_store(&rx_stop, false);
+    atomic_store(&rx_waiting, false);
+    if (!wakeup_open(&ui_wake) || !wakeup_open(&rx_wake) ||
+        pthread_create(&rx_thread, NULL, rx_main, NULL) != 0) {
+        socket_close();
+        return -1;
+    }
+    rx_running = true;
+    return 0;
 }
 
 void socket_send_cmd(const char *cmd) {
     if (sockfd < 0)
         return;
+    // 보내기 전에 이미 와 있는 응답은 이 명령의 것일 수 없음
+    dispatch_pushes();
+    drop_stray_replies();
 
-    char line[512];
+    char line[1025]; // 서버 명령 길이 제한(1023) + 개행 + NUL
     size_t len = strlen(cmd);
-    if (len >= sizeof(line))
-        len = sizeof(line) - 1;
+    if (len > sizeof(line) - 2)
+        len = sizeof(line) - 2;
     memcpy(line, cmd, len);
     line[len] = '\n';
     line[len + 1] = '\0';
     send(sockfd, line, len + 1, 0);
 }
 
-int socket_recv_response(char *outbuf, size_t size) {
-    int n = recv(sockfd, outbuf, size - 1, 0);
-    if (n > 0) outbuf[n] = 0;
-    return n;
+int socket_recv_line(char *outbuf, size_t size) {
+    if (sockfd < 0)
+        return -1;
+
+    for (;;) {
+        dispatch_pushes();
+        char *line = ring_take(&replies);
+        if (line) {
+            // 응답보다 먼저 도착한 푸시는 응답을 돌려주기 전에 모두 처리
+            dispatch_pushes();
+            snprintf(outbuf, size, "%s", line);
+            free(line);
+            return (int)strlen(outbuf);
+        }
+        if (atomic_load(&rx_closed)) {
+            if (replies.tail != replies.head)
+                continue; // 종료 직전에 들어온 응답
+            return -1;
+        }
+        struct pollfd p = {ui_wake.rfd, POLLIN, 0};
+        if (poll(&p, 1, -1) > 0)
+            drain_event();
+    }
+}
+
+int socket_poll_push(void) {
+    if (sockfd < 0)
+        return -1;
+    drain_event();
+    dispatch_pushes();
+    drop_stray_replies();
+    return atomic_load(&rx_closed) ? -1 : 0;
 }
 
 void socket_close(void) {
     if (sockfd >= 0) {
+        atomic_store(&rx_stop, true);
+        shutdown(sockfd, SHUT_RDWR); // 수신 스레드의 recv 를 깨움
+        if (rx_wake.wfd >= 0)
+            wakeup_signal(&rx_wake); // 큐 자리를 기다리며 잠들어 있으면 깨움
+        if (rx_running)
+            pthread_join(rx_thread, NULL);
+        rx_running = false;
         close(sockfd);
         sockfd = -1;
+        ring_clear(&replies);
+        ring_clear(&chats);
+        ring_clear(&notices);
     }
+    wakeup_close(&ui_wake);
+    wakeup_close(&rx_wake);
 }
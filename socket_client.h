@@ -5,7 +5,17 @@
 extern int sockfd;
 int socket_connect_to(const char *server_ip, int port);
 void socket_send_cmd(const char *cmd);
-int socket_recv_response(char *outbuf, size_t size);
+int socket_recv_line(char *outbuf, size_t size); // 서버 응답 한 줄 (개행 제거), 연결 종료 시 -1
+
+// 요청과 상관없이 서버가 밀어 보내는 줄("MSG ...", "INFO: ...")을 받을 콜백.
+// 수신 스레드가 모아 둔 것을 UI 스레드에서 호출하며, socket_recv_line 도중
+// 도착한 것도 여기로 넘어가고 응답으로는 돌려주지 않음
+typedef void (*socket_push_fn)(const char *line, void *ctx);
+void socket_set_push_handler(socket_push_fn fn, void *ctx);
+// 요청 사이(응답을 기다리지 않을 때)에 부름. 기다리지 않고 이미 도착한 푸시만 처리하고,
+// 어느 요청에도 속하지 않는 응답 줄은 푸시 콜백으로 넘겨 버림. 연결 종료 시 -1
+int socket_poll_push(void);
+int socket_event_fd(void);  // 수신 스레드가 새 줄을 넣으면 읽을 수 있게 되는 fd (poll 용)
 void socket_close(void);
 
 #endif
@@ -0,0 +1,75 @@
+#include "str_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+   문자열 풀
+   - 큰 블록에 이름을 차례로 붙여 담음 (항목마다 malloc/free 하지 않음)
+   - 같은 목록의 이름이 몇 개의 연속된 블록에 모여 있어 정렬/그리기에서
+     메모리를 흩어져 읽지 않음
+   - reset 은 블록을 비우기만 하고 다음 스캔에서 그대로 다시 씀
+   ============================================================ */
+struct StrBlock
+{
+    StrBlock *next;
+    size_t size, used;
+    char data[];
+};
+
+char *pool_strndup(StrPool *p, const char *s, size_t len)
+{
+    size_t need = len + 1;
+
+    // 지금 블록에 자리가 없으면 reset 뒤 남아 있는 다음 블록들 중에서 찾고, 없으면 새로 붙임
+    StrBlock *b = p->cur;
+    while (b && b->size - b->used < need)
+        b = b->next;
+    if (!b)
+    {
+        size_t size = need > STR_POOL_BLOCK ? need : STR_POOL_BLOCK;
+        b = malloc(sizeof(*b) + size);
+        if (!b)
+            return NULL;
+        b->next = NULL;
+        b->size = size;
+        b->used = 0;
+        if (p->tail)
+            p->tail->next = b;
+        else
+            p->first = b;
+        p->tail = b;
+    }
+    p->cur = b;
+
+    char *dst = b->data + b->used;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+    b->used += need;
+    p->bytes += need;
+    return dst;
+}
+
+char *pool_strdup(StrPool *p, const char *s)
+{
+    return pool_strndup(p, s, strlen(s));
+}
+
+void pool_reset(StrPool *p)
+{
+    for (StrBlock *b = p->first; b; b = b->next)
+        b->used = 0;
+    p->cur = p->first;
+    p->bytes = 0;
+}
+
+void pool_free(StrPool *p)
+{
+    StrBlock *b = p->first;
+    while (b)
+    {
+        StrBlock *next = b->next;
+        free(b);
+        b = next;
+    }
+    memset(p, 0, sizeof(*p));
+}
@@ -0,0 +1,22 @@
+#ifndef STR_POOL_H
+#define STR_POOL_H
+
+#include <stddef.h>
+
+#define STR_POOL_BLOCK (64 * 1024) // 블록 크기 (더 긴 문자열은 전용 블록)
+
+typedef struct StrBlock StrBlock;
+
+// 목록 하나의 이름들을 담는 문자열 풀. 문자열은 따로 해제하지 않고 풀 단위로 비움
+// 구조체를 복사해 넘기면 소유권도 넘어감 (원본은 0 으로 비울 것)
+typedef struct {
+    StrBlock *first, *cur, *tail;
+    size_t bytes;  // 지금 담긴 문자열 크기 합 (NUL 포함)
+} StrPool;
+
+char *pool_strdup(StrPool *p, const char *s);              // 메모리 부족이면 NULL
+char *pool_strndup(StrPool *p, const char *s, size_t len);
+void pool_reset(StrPool *p); // 모든 문자열을 버리되 블록은 남겨 다시 씀
+void pool_free(StrPool *p);
+
+#endif
@@ -6,20 +6,28 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <ctype.h>
+#include <time.h>
 
 #include "socket_client.h"
 
 #include "dir_manager.h"
+#include "local_scan.h"
 #include "chat_manager.h"
 #include "input_manager.h"
 #include "utils.h"
 #include "auth.h"
 
+#include <fcntl.h>
+#include <poll.h>
+
 #ifdef USE_INOTIFY
 #include <sys/inotify.h>
-#include <fcntl.h>
 #endif
 
+#define LIST_FETCH_AHEAD 32 // 선택이 목록 끝에서 이만큼 안쪽이면 다음 페이지 요청
+#define SESSION_TOKEN_MAX 65
+#define CHAT_POLL_FALLBACK_MS 1000 // inotify 없이 빌드했을 때 로그 변경 확인 주기
+
 static WINDOW *win_dir, *win_file, *win_chat, *win_input;
 
 typedef struct
@@ -28,7 +36,9 @@ typedef struct
     FileList fl;
     ChatState chat;
     FocusArea focus;
+    InputLine input;  // 입력창에서 쓰는 중인 줄 (포커스를 옮겨도 남음)
     char username[64];
+    char session[SESSION_TOKEN_MAX]; // 서버가 로그인 때 준 세션 토큰
     bool logged_in;
 } App;
 
@@ -97,19 +107,22 @@ static bool login_prompt(App *app)
         socket_send_cmd(cmd);
 
         char resp[256];
-        int rn = socket_recv_response(resp, sizeof(resp));
-        while (rn > 0 && strncmp(resp, "INFO:", 5) == 0)
-            rn = socket_recv_response(resp, sizeof(resp));
+        int rn = socket_recv_line(resp, sizeof(resp));
+        while (rn >= 0 && strncmp(resp, "INFO:", 5) == 0)
+            rn = socket_recv_line(resp, sizeof(resp));
 
-        if (rn > 0 && strncmp(resp, "OK:", 3) == 0)
+        if (rn >= 0 && strncmp(resp, "OK:", 3) == 0)
         {
             snprintf(app->username, sizeof(app->username), "%s", user);
             app->logged_in = true;
+            const char *tok = strstr(resp, "session=");
+            if (!tok || sscanf(tok + 8, "%64s", app->session) != 1)
+                app->session[0] = '\0';
             delwin(login);
             return true;
         }
 
-        const char *err_msg = rn > 0 ? resp : "로그인 응답 없음";
+        const char *err_msg = rn >= 0 ? resp : "로그인 응답 없음";
         mvwprintw(login, 6, 2, "서버 응답: %-50.50s", err_msg);
         
         mvwprintw(login, 7, 2, "로그인 실패(%d/3) - 다시 시도", attempt + 1);
@@ -117,12 +130,72 @@ static bool login_prompt(App *app)
         napms(1000);
         delwin(login);
 
-        if (rn > 0 && strncmp(resp, "ERR: account locked", 20) == 0)
+        if (rn >= 0 && strncmp(resp, "ERR: account locked", 20) == 0)
             break;
     }
     return false;
 }
 
+/* =======================================================
+   세션 토큰: 다음 실행 때 비밀번호 없이 RESUME 으로 접속
+   (~/.tui_chatops/session_<host>_<port>, 본인만 읽을 수 있게 0600)
+   ======================================================= */
+static void session_file(char out[PATH_MAX], const char *host, int port)
+{
+    char root[PATH_MAX];
+    get_home(root);
+    size_t n = strlen(root);
+    snprintf(root + n, sizeof(root) - n, "/.tui_chatops");
+    ensure_dir(root);
+    n = strlen(root);
+    snprintf(root + n, sizeof(root) - n, "/session_%s_%d", host, port);
+    memcpy(out, root, PATH_MAX);
+}
+
+static void session_save(const App *app, const char *host, int port)
+{
+    if (!app->session[0])
+        return;
+    char path[PATH_MAX];
+    session_file(path, host, port);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return;
+    dprintf(fd, "%s %s\n", app->username, app->session);
+    close(fd);
+}
+
+static bool session_resume(App *app, const char *host, int port)
+{
+    char path[PATH_MAX], line[256];
+    session_file(path, host, port);
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return false;
+    bool ok = fgets(line, sizeof(line), fp) &&
+              sscanf(line, "%63s %64s", app->username, app->session) == 2;
+    fclose(fp);
+    if (!ok)
+        return false;
+
+    char cmd[SESSION_TOKEN_MAX + 16], resp[256];
+    snprintf(cmd, sizeof(cmd), "RESUME %s", app->session);
+    socket_send_cmd(cmd);
+    int rn = socket_recv_line(resp, sizeof(resp));
+    while (rn >= 0 && strncmp(resp, "INFO:", 5) == 0)
+        rn = socket_recv_line(resp, sizeof(resp));
+
+    if (rn >= 0 && strncmp(resp, "OK:", 3) == 0)
+    {
+        app->logged_in = true;
+        return true;
+    }
+    // 만료/서버 재시작 등: 토큰을 버리고 로그인 창으로
+    unlink(path);
+    app->username[0] = app->session[0] = '\0';
+    return false;
+}
+
 /* =======================================================
    레이아웃 구성 (수정됨: 파일 목록을 우측 상단으로 이동)
    ======================================================= */
@@ -139,15 +212,19 @@ static void layout_create(void)
 
     // 1. 디렉토리 창 (좌측 전체)
     win_dir = newwin(h, left_w, 0, 0);
+    idlok(win_dir, TRUE); // 목록이 한 줄씩 밀릴 때 터미널 스크롤로
 
     // 2. 파일 목록 창 (우측 상단)
     win_file = newwin(file_h, right_w, 0, left_w);
+    idlok(win_file, TRUE);
 
     // 3. 채팅 창 (우측 하단)
     win_chat = newwin(chat_h, right_w, file_h, left_w);
+    idlok(win_chat, TRUE); // 새 채팅 줄은 터미널 스크롤로 (chat_draw 참고)
 
     // 4. 입력 창 (우측 최하단)
     win_input = newwin(input_h, right_w, h - input_h, left_w);
+    input_setup(win_input); // 입력 중에도 메인 루프가 멈추지 않게
 
     box(win_dir, 0, 0);
     mvwprintw(win_dir, 0, 2, " 디렉토리 ");
@@ -167,6 +244,90 @@ static void layout_create(void)
     wrefresh(win_input);
 }
 
+/* =======================================================
+   채팅 로그 감시 (inotify)
+   ======================================================= */
+#ifdef USE_INOTIFY
+static int inotify_fd = -1;
+static int log_wd = -1;
+static char watched_log[PATH_MAX];
+
+// 방을 옮겨 채팅 로그가 바뀌면 감시 대상도 새 로그로 옮김
+static void watch_chat_log(const char *path)
+{
+    if (inotify_fd < 0 || strcmp(watched_log, path) == 0)
+        return;
+    if (log_wd >= 0)
+        inotify_rm_watch(inotify_fd, log_wd);
+    log_wd = inotify_add_watch(inotify_fd, path, IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF);
+    snprintf(watched_log, sizeof(watched_log), "%s", path);
+}
+#else
+static void watch_chat_log(const char *path)
+{
+    (void)path;
+}
+#endif
+
+/* =======================================================
+   서버 채팅: 방 참여와 실시간 메시지
+   ======================================================= */
+// "MSG <room> <ts> <user> <text>": 지금 보고 있는 방의 것만 로그에 남김
+// "INFO: ...": 상태 줄에 잠깐 표시
+static void on_server_push(const char *line, void *ctx)
+{
+    App *a = ctx;
+    // 안내와, 어느 명령에도 속하지 않고 남은 오류 응답은 상태줄에 표시
+    if (strncmp(line, "INFO:", 5) == 0 || strncmp(line, "ERR", 3) == 0)
+    {
+        if (win_chat && a->logged_in)
+            status_bar(win_chat, line);
+        return;
+    }
+    char room[CHAT_ROOM_MAX], user[64];
+    long long ts = 0;
+    int off = 0;
+    if (sscanf(line, "MSG %255s %lld %63s %n", room, &ts, user, &off) < 3 || off == 0)
+        return;
+    if (strcmp(room, a->chat.room) != 0)
+        return;
+    chat_append_at(&a->chat, (time_t)ts, user, line + off);
+    chat_server_seen(&a->chat, ts);
+    a->chat.dirty = 1;
+}
+
+// 방에 참여하면서 로컬 로그에 없는 서버 기록을 받아 채움
+static void chat_join(App *a)
+{
+    if (!socket_is_connected())
+        return;
+    char cmd[CHAT_ROOM_MAX + 48], line[256];
+    // 로컬 시계가 아니라 서버가 붙인 ts 로 이어 받음 (같은 초의 기록은 받은 개수만큼 건너뜀)
+    long long since;
+    int seen;
+    if (chat_server_since(&a->chat, &since, &seen))
+        snprintf(cmd, sizeof(cmd), "JOIN %s %lld %d", a->chat.room, since, seen);
+    else
+        snprintf(cmd, sizeof(cmd), "JOIN %s", a->chat.room);
+    socket_send_cmd(cmd);
+
+    // 재전송되는 MSG 줄은 on_server_push 로 들어오므로 묶어서 한 번에 기록
+    chat_begin_batch(&a->chat);
+    while (socket_recv_line(line, sizeof(line)) >= 0)
+    {
+        if (strncmp(line, "ENDHIST", 7) == 0 || strncmp(line, "ERR", 3) == 0)
+            break;
+    }
+    chat_end_batch(&a->chat);
+}
+
+static void chat_open(App *a, const char *dir_abs)
+{
+    chat_init(&a->chat, dir_abs);
+    chat_join(a);
+    watch_chat_log(a->chat.log_path);
+}
+
 /* =======================================================
    초기화
    ======================================================= */
@@ -175,9 +336,11 @@ static void app_init(App *a)
     a->focus = FOCUS_DIR;
 
     // [수정] 시작 디렉토리를 현재 폴더('.')로 변경
+    //        서버에 접속해 있으면 서버 세션의 작업 디렉토리에서 시작
     const char *start_dir = ".";
     char absdir[PATH_MAX];
-    abspath(absdir, start_dir);
+    if (!socket_is_connected() || !remote_pwd(absdir))
+        abspath(absdir, strcmp(start_dir, ".") == 0 ? NULL : start_dir); // 로컬 모드: 끝에 "/." 가 붙지 않게
 
     // 디렉토리 목록 초기화
     dirlist_init(&a->dl);
@@ -189,18 +352,14 @@ static void app_init(App *a)
     filelist_scan(&a->fl, base_dir);
 
     // 채팅창 초기화
-    chat_init(&a->chat, base_dir);
+    chat_open(a, base_dir);
 
     // 즉시 전체 화면 갱신
     dirlist_draw(win_dir, &a->dl, true);
     filelist_draw(win_file, &a->fl, false);
     chat_draw(win_chat, &a->chat);
-    input_draw(win_input);
-
-    wrefresh(win_dir);
-    wrefresh(win_file);
-    wrefresh(win_chat);
-    wrefresh(win_input);
+    input_draw(win_input, &a->input);
+    doupdate();
 
     status_bar(win_chat, "[Tab] 포커스 이동  [Enter] 선택/전송  [Backspace] 상위  [q] 종료");
 }
@@ -212,6 +371,7 @@ static void app_free(App *a)
 {
     dirlist_free(&a->dl);
     filelist_free(&a->fl);
+    chat_free(&a->chat);
 }
 
 /* =======================================================
@@ -224,7 +384,101 @@ static void change_focus(App *a, int dir)
     a->focus = (FocusArea)f;
     dirlist_draw(win_dir, &a->dl, a->focus == FOCUS_DIR);
     filelist_draw(win_file, &a->fl, a->focus == FOCUS_FILE);
-    chat_draw(win_chat, &a->chat);
+}
+
+/* =======================================================
+   목록 이동 (위/아래, PgUp/PgDn, Home/End)
+   ======================================================= */
+static int list_target(int ch, int selected, int count, int page)
+{
+    switch (ch)
+    {
+    case KEY_UP:    return selected - 1;
+    case KEY_DOWN:  return selected + 1;
+    case KEY_PPAGE: return selected - page;
+    case KEY_NPAGE: return selected + page;
+    case KEY_HOME:  return 0;
+    case KEY_END:   return count - 1;
+    default:        return selected;
+    }
+}
+
+static bool fetch_dirs(void *list) { return dirlist_fetch_more(list); }
+static bool fetch_files(void *list) { return filelist_fetch_more(list); }
+
+// 이동 키면 선택을 옮기고 true. 원격 목록은 목표가 끝에 가까우면 다음 페이지를 미리 받아옴
+// (End 는 이미 받은 목록의 끝까지만: 백만 항목을 한 번에 받지 않도록)
+static bool list_move(int ch, int *selected, const int *count, const bool *more,
+                      int page, bool (*fetch)(void *), void *list)
+{
+    if (ch != KEY_UP && ch != KEY_DOWN && ch != KEY_PPAGE && ch != KEY_NPAGE &&
+        ch != KEY_HOME && ch != KEY_END)
+        return false;
+    while (ch != KEY_END && *more &&
+           list_target(ch, *selected, *count, page) >= *count - LIST_FETCH_AHEAD)
+    {
+        if (!fetch(list))
+            break;
+    }
+    int t = list_target(ch, *selected, *count, page);
+    if (t > *count - 1)
+        t = *count - 1;
+    if (t < 0)
+        t = (*count > 0) ? 0 : -1;
+    *selected = t;
+    return true;
+}
+
+/* =======================================================
+   목록 필터: '/' 로 시작, 글자를 칠 때마다 결과를 좁힘
+   (Esc 취소, Enter/Tab/좌우는 고른 항목을 선택한 채 닫고 원래 동작으로)
+   ======================================================= */
+static void filter_start(ListFilter *f, ListView *v, char *const *items, int count,
+                         int selected, bool basename)
+{
+    if (filter_begin(f, items, count, selected, basename))
+        listview_invalidate(v);
+}
+
+// 처리했으면 true, 필터를 닫고 원래 목록의 키 처리로 넘길 키면 false
+static bool filter_key(int ch, ListFilter *f, ListView *v, int *selected, int page)
+{
+    static const bool no_more = false;
+    if (list_move(ch, &f->selected, &filter_result(f)->count, &no_more, page, NULL, NULL))
+    {
+        if (filter_item(f) >= 0)
+            *selected = filter_item(f);
+        return true;
+    }
+
+    bool cancel = (ch == 27) || ((ch == KEY_BACKSPACE || ch == 127) && f->len == 0);
+    bool accept = (ch == '\n' || ch == '\t' || ch == KEY_BTAB || ch == KEY_LEFT || ch == KEY_RIGHT);
+    if (cancel || accept)
+    {
+        int item = cancel ? f->origin : filter_item(f);
+        filter_end(f);
+        if (item >= 0)
+            *selected = item;
+        listview_invalidate(v);
+        return cancel;
+    }
+
+    if (ch == KEY_BACKSPACE || ch == 127)
+        filter_pop(f);
+    else if (ch >= ' ' && ch < 256)
+        filter_push(f, (char)ch);
+    else
+        return true;
+    if (filter_item(f) >= 0)
+        *selected = filter_item(f);
+    listview_invalidate(v);
+    return true;
+}
+
+static bool filtering(const App *a)
+{
+    return (a->focus == FOCUS_DIR && a->dl.filter.active) ||
+           (a->focus == FOCUS_FILE && a->fl.filter.active);
 }
 
 /* =======================================================
@@ -237,7 +491,8 @@ static void open_selected_dir(App *a)
     const char *dir_abs = a->dl.items[a->dl.selected];
     filelist_scan(&a->fl, dir_abs);
     filelist_draw(win_file, &a->fl, a->focus == FOCUS_FILE);
-    chat_init(&a->chat, dir_abs);
+    doupdate(); // 채팅 기록을 받는 동안에도 목록은 먼저 보이도록
+    chat_open(a, dir_abs);
     chat_draw(win_chat, &a->chat);
 }
 
@@ -261,19 +516,91 @@ static void go_parent_dir(App *a)
 }
 
 /* =======================================================
-   inotify (Linux용)
+   입력창에서 Enter 친 줄 처리: 서버 명령(cd/mkdir/ls) 또는 채팅
    ======================================================= */
-#ifdef USE_INOTIFY
-static int setup_inotify(const char *path)
+static void submit_input(App *a, const char *linebuf)
 {
-    int fd = inotify_init1(IN_NONBLOCK);
-    if (fd < 0)
-        return -1;
-    inotify_add_watch(fd, path, IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF);
-    return fd;
+    if (strncmp(linebuf, "cd ", 3) == 0 || strncmp(linebuf, "mkdir ", 6) == 0 || strncmp(linebuf, "ls", 2) == 0)
+    {
+        socket_send_cmd(linebuf);
+
+        char response[2048];
+        bool is_ls = strncmp(linebuf, "ls", 2) == 0;
+        // 응답 줄마다 파일을 열고 닫지 않도록 묶어서 기록
+        chat_begin_batch(&a->chat);
+        while (socket_recv_line(response, sizeof(response)) >= 0)
+        {
+            // [수정됨] 수동 ls 명령 시 ENDLS 줄을 만나면 루프 종료 (화면에 출력하지 않음)
+            if (strcmp(response, "ENDLS") == 0)
+                break;
+
+            chat_append(&a->chat, "server", response);
+            if (!is_ls && (strncmp(response, "OK", 2) == 0 || strncmp(response, "ERR", 3) == 0))
+                break;
+        }
+        chat_end_batch(&a->chat);
+        a->chat.dirty = 1;
+        return;
+    }
+
+    const char *user = a->username[0] ? a->username : safe_username();
+    if (strlen(linebuf) == 0)
+        return;
+    chat_append(&a->chat, user, linebuf);
+    a->chat.dirty = 1;
+    if (socket_is_connected())
+    {
+        // 서버 방 기록에 남기고 같은 방 사용자에게 전달
+        char cmd[CHAT_ROOM_MAX + INPUT_LINE_MAX + 8], response[256];
+        snprintf(cmd, sizeof(cmd), "SAY %s %s", a->chat.room, linebuf);
+        socket_send_cmd(cmd);
+        long long ts;
+        if (socket_recv_line(response, sizeof(response)) < 0)
+            response[0] = '\0';
+        if (strncmp(response, "ERR", 3) == 0)
+            chat_append(&a->chat, "server", response);
+        else if (sscanf(response, "ACK: message received ts=%lld", &ts) == 1)
+            chat_server_seen(&a->chat, ts); // 내 메시지는 MSG 로 돌아오지 않음
+    }
 }
+
+/* =======================================================
+   이벤트 대기: 키 입력 / 서버 수신(socket_event_fd) / 채팅 로그 변경 중
+   하나가 올 때까지 잠듦. inotify 가 없으면 로그 변경은 일정 주기로 확인
+   ======================================================= */
+static void wait_for_events(App *a)
+{
+    struct pollfd fds[3];
+    int n = 0;
+    int timeout_ms = CHAT_POLL_FALLBACK_MS;
+    fds[n++] = (struct pollfd){STDIN_FILENO, POLLIN, 0};
+    if (socket_event_fd() >= 0)
+        fds[n++] = (struct pollfd){socket_event_fd(), POLLIN, 0};
+#ifdef USE_INOTIFY
+    int ino = n;
+    if (inotify_fd >= 0)
+    {
+        fds[n++] = (struct pollfd){inotify_fd, POLLIN, 0};
+        timeout_ms = -1;
+    }
 #endif
 
+    if (poll(fds, (nfds_t)n, timeout_ms) <= 0)
+        return;
+
+#ifdef USE_INOTIFY
+    if (inotify_fd >= 0 && (fds[ino].revents & POLLIN))
+    {
+        char buf[4096];
+        while (read(inotify_fd, buf, sizeof(buf)) > 0)
+            ;
+        a->chat.dirty = 1;
+    }
+#else
+    (void)a;
+#endif
+}
+
 /* =======================================================
    메인 루프
    ======================================================= */
@@ -305,86 +632,109 @@ int main(int argc, char *argv[])
         }
     }
 
-    if (socket_connect_to(host, port) < 0)
-    {
-        fprintf(stderr, "[tui] connect failed: %s:%d\n", host, port);
-        return 1;
-    }
+    // 서버에 붙지 못하면 로컬 모드로 계속: 목록은 로컬 디렉토리를 직접 스캔, 채팅은 로컬 로그에만 기록
+    bool offline = socket_connect_to(host, port) < 0;
+    if (offline)
+        fprintf(stderr, "[tui] connect failed: %s:%d (local mode)\n", host, port);
+
+    // 채팅 로그 내구성: TUI_CHAT_SYNC=none|batch|always
+    const char *sync_env = getenv("TUI_CHAT_SYNC");
+    if (sync_env && strcmp(sync_env, "batch") == 0)
+        chat_set_durability(CHAT_SYNC_BATCH);
+    else if (sync_env && strcmp(sync_env, "always") == 0)
+        chat_set_durability(CHAT_SYNC_ALWAYS);
+
+    // 로컬 스캔에서 stat 을 나눠 맡을 스레드 수 (네트워크 파일시스템용): TUI_SCAN_THREADS=N
+    const char *scan_env = getenv("TUI_SCAN_THREADS");
+    if (scan_env)
+        local_scan_set_threads(atoi(scan_env));
 
     setlocale(LC_ALL, "");
     initscr();
     noecho();
     cbreak();
     keypad(stdscr, TRUE);
+    set_escdelay(25); // 필터 취소(Esc)가 바로 먹도록
     curs_set(0);
-    timeout(200); 
+    timeout(0); // getch 는 기다리지 않음 (대기는 wait_for_events 의 poll 에서)
 
     clear();
     refresh();
 
     App app;
     memset(&app, 0, sizeof(app));
+    socket_set_push_handler(on_server_push, &app);
 
-    if (!login_prompt(&app))
+    if (offline)
     {
-        endwin();
-        socket_close();
-        fprintf(stderr, "[tui] login failed\n");
-        return 1;
+        snprintf(app.username, sizeof(app.username), "%s", safe_username());
+    }
+    else if (!session_resume(&app, host, port))
+    {
+        if (!login_prompt(&app))
+        {
+            endwin();
+            socket_close();
+            fprintf(stderr, "[tui] login failed\n");
+            return 1;
+        }
+        session_save(&app, host, port);
     }
 
     clear();
     refresh();
     layout_create();
+#ifdef USE_INOTIFY
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
 
     app_init(&app);
 
     refresh();
 
-#ifdef USE_INOTIFY
-    int inofd = setup_inotify(app.chat.log_path);
-#endif
-
-    char linebuf[4096] = {0};
-
     for (;;)
     {
+        socket_poll_push();
         chat_check_update(&app.chat);
         if (app.chat.dirty)
         {
             app.chat.dirty = 0;
             chat_draw(win_chat, &app.chat);
         }
+        // 이번 차례에 바뀐 창들을 한 번에 내보냄
+        doupdate();
 
-#ifdef USE_INOTIFY
-        if (inofd >= 0)
-        {
-            char buf[1024];
-            int n = read(inofd, buf, sizeof(buf));
-            if (n > 0)
-                app.chat.dirty = 1;
-        }
-#endif
-
-        int ch = getch();
+        // ncurses 가 이미 읽어 둔 키가 있으면 먼저 처리하고, 없을 때만 잠듦
+        // 입력창에서는 그 창에서 읽어 커서를 입력 위치에 둠 (nodelay 라 기다리지 않음)
+        curs_set(app.focus == FOCUS_INPUT ? 1 : 0);
+        int ch = (app.focus == FOCUS_INPUT) ? wgetch(win_input) : getch();
         if (ch == ERR)
+        {
+            wait_for_events(&app);
             continue;
-        if (ch == 'q' || ch == 'Q')
+        }
+        if ((ch == 'q' || ch == 'Q') && !filtering(&app) && app.focus != FOCUS_INPUT)
             break;
 
         switch (app.focus)
         {
         case FOCUS_DIR:
-            if (ch == KEY_UP)
+            if (app.dl.filter.active)
+            {
+                bool handled = filter_key(ch, &app.dl.filter, &app.dl.view, &app.dl.selected,
+                                          listview_rows(win_dir));
+                dirlist_draw(win_dir, &app.dl, true);
+                if (handled)
+                    break;
+            }
+            if (ch == '/')
             {
-                if (app.dl.selected > 0)
-                    app.dl.selected--;
+                filter_start(&app.dl.filter, &app.dl.view, app.dl.items, app.dl.count, app.dl.selected, true);
                 dirlist_draw(win_dir, &app.dl, true);
             }
-            else if (ch == KEY_DOWN)
+            else if (list_move(ch, &app.dl.selected, &app.dl.count, &app.dl.more,
+                          listview_rows(win_dir), fetch_dirs, &app.dl))
             {
-                if (app.dl.selected < app.dl.count - 1)
-                    app.dl.selected++;
                 dirlist_draw(win_dir, &app.dl, true);
             }
             else if (ch == '\n' || ch == KEY_RIGHT)
@@ -400,16 +750,22 @@ int main(int argc, char *argv[])
             break;
 
         case FOCUS_FILE:
-            if (ch == KEY_UP)
+            if (app.fl.filter.active)
+            {
+                bool handled = filter_key(ch, &app.fl.filter, &app.fl.view, &app.fl.selected,
+                                          listview_rows(win_file));
+                filelist_draw(win_file, &app.fl, true);
+                if (handled)
+                    break;
+            }
+            if (ch == '/')
             {
-                if (app.fl.selected > 0)
-                    app.fl.selected--;
+                filter_start(&app.fl.filter, &app.fl.view, app.fl.items, app.fl.count, app.fl.selected, false);
                 filelist_draw(win_file, &app.fl, true);
             }
-            else if (ch == KEY_DOWN)
+            else if (list_move(ch, &app.fl.selected, &app.fl.count, &app.fl.more,
+                          listview_rows(win_file), fetch_files, &app.fl))
             {
-                if (app.fl.selected < app.fl.count - 1)
-                    app.fl.selected++;
                 filelist_draw(win_file, &app.fl, true);
             }
             else if (ch == '\n')
@@ -439,10 +795,25 @@ int main(int argc, char *argv[])
             break;
 
         case FOCUS_CHAT:
-            if (ch == '\t' || ch == KEY_RIGHT || ch == '\n')
+            // 스크롤백: 색인을 통해 오래된 기록도 바로 이동
+            if (ch == KEY_UP || ch == KEY_DOWN || ch == KEY_PPAGE || ch == KEY_NPAGE || ch == KEY_END)
+            {
+                int page = getmaxy(win_chat) - 2;
+                if (ch == KEY_UP)
+                    chat_scroll(&app.chat, 1);
+                else if (ch == KEY_DOWN)
+                    chat_scroll(&app.chat, -1);
+                else if (ch == KEY_PPAGE)
+                    chat_scroll(&app.chat, page);
+                else if (ch == KEY_NPAGE)
+                    chat_scroll(&app.chat, -page);
+                else
+                    chat_scroll(&app.chat, -app.chat.scroll);
+            }
+            else if (ch == '\t' || ch == KEY_RIGHT || ch == '\n')
             {
                 app.focus = FOCUS_INPUT;
-                input_draw(win_input);
+                input_draw(win_input, &app.input);
             }
             else if (ch == KEY_LEFT)
             {
@@ -452,48 +823,20 @@ int main(int argc, char *argv[])
             break;
 
         case FOCUS_INPUT:
-            if (ch == '\n')
-            {
-            }
-            else
+            if (ch == '\t' || ch == KEY_BTAB)
+                break; // 아래에서 포커스 이동 (쓰던 줄은 남음)
+            switch (input_key(win_input, &app.input, ch))
             {
-                input_draw(win_input);
-                wmove(win_input, 1, 4);
-                linebuf[0] = '\0';
-                input_capture_line(win_input, linebuf, sizeof(linebuf));
-                
-                if (strncmp(linebuf, "cd ", 3) == 0 || strncmp(linebuf, "mkdir ", 6) == 0 || strncmp(linebuf, "ls", 2) == 0)
-                {
-                    socket_send_cmd(linebuf);
-
-                    char response[2048];
-                    while (socket_recv_response(response, sizeof(response)) > 0)
-                    {
-                        // [수정됨] 수동 ls 명령 시 ENDLS를 만나면 루프 종료
-                        if (strstr(response, "ENDLS")) {
-                            char *p = strstr(response, "ENDLS");
-                            *p = '\0'; // 화면에 ENDLS는 출력하지 않음
-                            if (strlen(response) > 0) 
-                                chat_append(&app.chat, "server", response);
-                            break;
-                        }
-
-                        chat_append(&app.chat, "server", response);
-                        if (strstr(response, "OK") || strstr(response, "ERR"))
-                            break;
-                    }
-                    app.chat.dirty = 1;
-                }
-                else
-                {
-                    const char *user = app.username[0] ? app.username : safe_username();
-                    if (strlen(linebuf) > 0)
-                    {
-                        chat_append(&app.chat, user, linebuf);
-                        app.chat.dirty = 1;
-                    }
-                }
+            case INPUT_SUBMIT:
+                submit_input(&app, app.input.buf);
+                input_clear(&app.input);
+                input_draw(win_input, &app.input);
+                break;
+            case INPUT_LEAVE:
                 app.focus = FOCUS_CHAT;
+                break;
+            case INPUT_EDITING:
+                break;
             }
             break;
         }
@@ -506,5 +849,6 @@ int main(int argc, char *argv[])
 
     app_free(&app);
     endwin();
+    socket_close();
     return 0;
 }
\ No newline at end of file